@@ -67,12 +67,15 @@
  *----------------------------------------------------------*/
 
 #define configUSE_PREEMPTION                1
-#define configUSE_IDLE_HOOK                 0
+#define configUSE_IDLE_HOOK                 1
 #define configUSE_TICK_HOOK                 0
 #define configCPU_CLOCK_HZ                  ( ( unsigned long ) 50000000 )
 #define configTICK_RATE_HZ                  ( ( portTickType ) 1000 )
 #define configMINIMAL_STACK_SIZE            ( ( unsigned short ) 200 )
-#define configTOTAL_HEAP_SIZE               ( ( size_t ) ( 30000 ) )
+/* Task stacks are static, so the heap only holds the TCBs, the idle task's
+stack, the Sensor queue and the log semaphore: about 1.3 KB. The Sensor
+task logs what is left at start-up. */
+#define configTOTAL_HEAP_SIZE               ( ( size_t ) ( 2048 ) )
 #define configMAX_TASK_NAME_LEN             ( 12 )
 #define configUSE_TRACE_FACILITY            1
 #define configUSE_16_BIT_TICKS              0
@@ -86,6 +89,13 @@
 #define configMAX_CO_ROUTINE_PRIORITIES     ( 2 )
 #define configQUEUE_REGISTRY_SIZE           10
 
+/* Run-time stats are counted by Wide Timer 0A; see runtime_stats.c. */
+#define configGENERATE_RUN_TIME_STATS       1
+extern void RunTimeStatsInit( void );
+extern unsigned long RunTimeStatsCounter( void );
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    RunTimeStatsInit()
+#define portGET_RUN_TIME_COUNTER_VALUE()            RunTimeStatsCounter()
+
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function. */
 
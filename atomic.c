@@ -0,0 +1,67 @@
+#include <stdbool.h>
+#include <stdint.h>
+#if !defined(ccs) && !defined(__STDC_NO_ATOMICS__) &&                          \
+    defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#include <stdatomic.h>
+#define ATOMIC_C11
+#endif
+#include "atomic.h"
+
+//*****************************************************************************
+//
+// Atomically replaces *pui32Addr with ui32New if it still holds ui32Old.
+// Returns false, changing nothing, if it did not, or if the update was
+// interrupted.
+//
+//*****************************************************************************
+bool
+AtomicCompareAndSwap(volatile uint32_t *pui32Addr, uint32_t ui32Old,
+                     uint32_t ui32New)
+{
+#if defined(ccs)
+    if((uint32_t)__ldrex((void *)pui32Addr) != ui32Old)
+    {
+        __clrex();
+        return(false);
+    }
+    return(__strex(ui32New, (void *)pui32Addr) == 0);
+#else
+    return(__sync_bool_compare_and_swap(pui32Addr, ui32Old, ui32New));
+#endif
+}
+
+//*****************************************************************************
+//
+// Atomically adds i32Delta to *pui32Addr and returns the new value.
+//
+//*****************************************************************************
+uint32_t
+AtomicAdd(volatile uint32_t *pui32Addr, int32_t i32Delta)
+{
+    uint32_t ui32Old;
+
+    do
+    {
+        ui32Old = *pui32Addr;
+    }
+    while(!AtomicCompareAndSwap(pui32Addr, ui32Old, ui32Old + i32Delta));
+
+    return(ui32Old + i32Delta);
+}
+
+//*****************************************************************************
+//
+// A full memory barrier. Being a call, it is also a compiler barrier.
+//
+//*****************************************************************************
+void
+AtomicBarrier(void)
+{
+#if defined(ccs)
+    __asm("    dmb");
+#elif defined(ATOMIC_C11)
+    atomic_thread_fence(memory_order_seq_cst);
+#else
+    __sync_synchronize();
+#endif
+}
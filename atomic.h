@@ -0,0 +1,21 @@
+#ifndef __ATOMIC_H__
+#define __ATOMIC_H__
+
+//*****************************************************************************
+//
+// Lock-free updates of shared words, safe between tasks and interrupt
+// handlers. On the target they use LDREX/STREX, whose reservation any
+// exception clears, so an update interrupted by another one simply fails
+// and is retried. Host builds use the GCC builtins.
+//
+// AtomicBarrier() keeps the memory accesses before it ahead of those after
+// it, for both the compiler and the CPU; it is DMB on the target and a C11
+// fence on the host.
+//
+//*****************************************************************************
+extern bool AtomicCompareAndSwap(volatile uint32_t *pui32Addr,
+                                 uint32_t ui32Old, uint32_t ui32New);
+extern uint32_t AtomicAdd(volatile uint32_t *pui32Addr, int32_t i32Delta);
+extern void AtomicBarrier(void);
+
+#endif // __ATOMIC_H__
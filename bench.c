@@ -0,0 +1,206 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "bench.h"
+
+#if BENCH_MODE
+#if defined(BSP_HOST_SIM)
+#include <stdio.h>
+#include "inc/bsp_sim.h"
+#define HWREG(x)                   SIM_REG(x)
+#else
+#include "inc/hw_types.h"
+#include "utils/uartstdio.h"
+#endif
+#include "inc/bsp.h"
+
+//*****************************************************************************
+//
+// The DWT cycle counter and the debug register that powers the DWT. The
+// host model has a stub of them that counts simulated cycles.
+//
+//*****************************************************************************
+#define DEMCR                      0xE000EDFC
+#define DEMCR_TRCENA               0x01000000
+#define DWT_CTRL                   0xE0001000
+#define DWT_CTRL_CYCCNTENA         0x00000001
+#define DWT_CYCCNT                 0xE0001004
+
+#if defined(BSP_HOST_SIM)
+#define BenchPrintf                printf
+#define BENCH_UNITS                "sim cycles"
+#else
+#define BenchPrintf                UARTprintf
+#define BENCH_UNITS                "cycles"
+#endif
+
+//*****************************************************************************
+//
+// The times of the function being measured.
+//
+//*****************************************************************************
+static uint32_t g_pui32BenchTimes[BENCH_ITERATIONS];
+static uint32_t g_ui32BenchIteration;
+
+//*****************************************************************************
+//
+// Starts the time base.
+//
+//*****************************************************************************
+static void
+BenchTimerInit(void)
+{
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+}
+
+//*****************************************************************************
+//
+// Returns the current time. The counter wraps, but differences stay right.
+//
+//*****************************************************************************
+static uint32_t
+BenchTime(void)
+{
+    return(HWREG(DWT_CYCCNT));
+}
+
+//*****************************************************************************
+//
+// The bodies. Each makes one call, so the empty body gives the overhead of
+// the measurement itself, which is taken off the others.
+//
+//*****************************************************************************
+static void
+BenchEmpty(void)
+{
+}
+
+static void
+BenchAccelerometerInput(void)
+{
+    uint16_t ui16X, ui16Y, ui16Z;
+
+    BSP_Accelerometer_Input(&ui16X, &ui16Y, &ui16Z);
+}
+
+static void
+BenchI2CSend3(void)
+{
+    BSP_Bench_I2C_Send3();
+}
+
+static void
+BenchI2CRecv2(void)
+{
+    BSP_Bench_I2C_Recv2();
+}
+
+static void
+BenchLightSensorEnd(void)
+{
+    BSP_Bench_LightSensorEnd();
+}
+
+#if !defined(BSP_HOST_SIM)
+static void
+BenchUARTprintf(void)
+{
+    //
+    // Overwrites itself on the terminal.
+    //
+    UARTprintf("%3d\r", g_ui32BenchIteration);
+}
+#endif
+
+typedef struct
+{
+    const char *pcName;
+    void (*pfnBody)(void);
+}
+tBench;
+
+static const tBench g_psBenches[] =
+{
+    { "(empty)", BenchEmpty },
+    { "BSP_Accelerometer_Input", BenchAccelerometerInput },
+    { "I2C_Send3", BenchI2CSend3 },
+    { "I2C_Recv2", BenchI2CRecv2 },
+    { "lightsensorend", BenchLightSensorEnd },
+#if !defined(BSP_HOST_SIM)
+    { "UARTprintf", BenchUARTprintf },
+#endif
+};
+
+#define NUM_BENCHES                (sizeof(g_psBenches) / sizeof(g_psBenches[0]))
+
+//*****************************************************************************
+//
+// Times BENCH_ITERATIONS calls of pfnBody into g_pui32BenchTimes, less
+// ui32Overhead, and sorts them.
+//
+//*****************************************************************************
+static void
+BenchMeasure(void (*pfnBody)(void), uint32_t ui32Overhead)
+{
+    uint32_t ui32Start, ui32Time, i, j;
+
+    for(i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        g_ui32BenchIteration = i;
+        ui32Start = BenchTime();
+        pfnBody();
+        ui32Time = BenchTime() - ui32Start;
+        g_pui32BenchTimes[i] = (ui32Time > ui32Overhead) ?
+                               (ui32Time - ui32Overhead) : 0;
+    }
+
+    //
+    // Insertion sort; the list is short and mostly in order already.
+    //
+    for(i = 1; i < BENCH_ITERATIONS; i++)
+    {
+        ui32Time = g_pui32BenchTimes[i];
+        for(j = i; (j > 0) && (g_pui32BenchTimes[j - 1] > ui32Time); j--)
+        {
+            g_pui32BenchTimes[j] = g_pui32BenchTimes[j - 1];
+        }
+        g_pui32BenchTimes[j] = ui32Time;
+    }
+}
+
+//*****************************************************************************
+//
+// Initializes the sensors the bodies use, times every body, and prints one
+// line each. Runs before the scheduler, with the UART not yet shared.
+//
+//*****************************************************************************
+void
+BenchRun(void)
+{
+    uint32_t ui32Overhead, i;
+
+    BenchTimerInit();
+    BSP_Accelerometer_Init();
+    BSP_LightSensor_Init();
+
+    //
+    // The fastest empty call is the cost of the measurement.
+    //
+    BenchMeasure(BenchEmpty, 0);
+    ui32Overhead = g_pui32BenchTimes[0];
+
+    BenchPrintf("\nBSP benchmark, %d calls each, " BENCH_UNITS
+                " less %d overhead\n", BENCH_ITERATIONS, ui32Overhead);
+    BenchPrintf("     min   median      p99      max\n");
+    for(i = 0; i < NUM_BENCHES; i++)
+    {
+        BenchMeasure(g_psBenches[i].pfnBody, ui32Overhead);
+        BenchPrintf("%8d %8d %8d %8d  %s\n", g_pui32BenchTimes[0],
+                    g_pui32BenchTimes[BENCH_ITERATIONS / 2],
+                    g_pui32BenchTimes[(BENCH_ITERATIONS * 99) / 100],
+                    g_pui32BenchTimes[BENCH_ITERATIONS - 1],
+                    g_psBenches[i].pcName);
+    }
+}
+#endif // BENCH_MODE
@@ -0,0 +1,25 @@
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+//*****************************************************************************
+//
+// Microbenchmarks of the BSP entry points. Build with BENCH_MODE defined to
+// 1 (for example -DBENCH_MODE=1) and main() times each one before starting
+// the application, reporting the spread over UART0.
+//
+// On the target the times are core cycles from the DWT cycle counter. A
+// host build (BSP_HOST_SIM, tools/bsp_sim.c) runs the same bodies against the
+// peripheral model, whose stub of the counter runs in simulated cycles.
+//
+//*****************************************************************************
+#ifndef BENCH_MODE
+#define BENCH_MODE                 0
+#endif
+
+// Calls timed per function.
+#define BENCH_ITERATIONS           256
+
+// Prototypes for the benchmark.
+extern void BenchRun(void);
+
+#endif // __BENCH_H__
@@ -0,0 +1,134 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "console.h"
+
+//*****************************************************************************
+//
+// Prepares psConsole to run the ui32NumCommands commands in psCommands.
+//
+//*****************************************************************************
+void
+ConsoleInit(tConsole *psConsole, const tConsoleCommand *psCommands,
+            uint32_t ui32NumCommands)
+{
+    psConsole->psCommands = psCommands;
+    psConsole->ui32NumCommands = ui32NumCommands;
+    psConsole->ui32Len = 0;
+    psConsole->bOverflow = false;
+}
+
+//*****************************************************************************
+//
+// Adds one received byte to the current line. Returns CONSOLE_PENDING until
+// the line ends, then the result of running it. Backspace and delete remove
+// the last character; a line that overflows is thrown away whole.
+//
+//*****************************************************************************
+int
+ConsoleFeed(tConsole *psConsole, char cChar)
+{
+    int iResult;
+
+    if((cChar == '\r') || (cChar == '\n'))
+    {
+        psConsole->pcLine[psConsole->ui32Len] = '\0';
+        iResult = psConsole->bOverflow ? CONSOLE_TOO_LONG :
+                  ConsoleProcess(psConsole, psConsole->pcLine);
+        psConsole->ui32Len = 0;
+        psConsole->bOverflow = false;
+        return(iResult);
+    }
+
+    if((cChar == '\b') || (cChar == 0x7F))
+    {
+        if(psConsole->ui32Len != 0)
+        {
+            psConsole->ui32Len--;
+        }
+    }
+    else if(psConsole->ui32Len < (CONSOLE_LINE_SIZE - 1))
+    {
+        psConsole->pcLine[psConsole->ui32Len++] = cChar;
+    }
+    else
+    {
+        psConsole->bOverflow = true;
+    }
+    return(CONSOLE_PENDING);
+}
+
+//*****************************************************************************
+//
+// Splits pcLine, in place, into words separated by spaces or tabs and runs
+// the command named by the first one.
+//
+//*****************************************************************************
+int
+ConsoleProcess(tConsole *psConsole, char *pcLine)
+{
+    char *ppcArgv[CONSOLE_MAX_ARGS];
+    int iArgc = 0;
+    bool bInWord = false;
+    uint32_t i;
+
+    for(; *pcLine; pcLine++)
+    {
+        if((*pcLine == ' ') || (*pcLine == '\t'))
+        {
+            *pcLine = '\0';
+            bInWord = false;
+        }
+        else if(!bInWord)
+        {
+            if(iArgc == CONSOLE_MAX_ARGS)
+            {
+                return(CONSOLE_TOO_MANY_ARGS);
+            }
+            ppcArgv[iArgc++] = pcLine;
+            bInWord = true;
+        }
+    }
+
+    if(iArgc == 0)
+    {
+        return(CONSOLE_EMPTY);
+    }
+
+    for(i = 0; i < psConsole->ui32NumCommands; i++)
+    {
+        if(strcmp(ppcArgv[0], psConsole->psCommands[i].pcCmd) == 0)
+        {
+            return(psConsole->psCommands[i].pfnCmd(iArgc, ppcArgv));
+        }
+    }
+    return(CONSOLE_BAD_CMD);
+}
+
+//*****************************************************************************
+//
+// Parses an unsigned decimal number. Returns false if pcString is not one
+// or does not fit in 32 bits.
+//
+//*****************************************************************************
+bool
+ConsoleNumber(const char *pcString, uint32_t *pui32Value)
+{
+    uint32_t ui32Value = 0;
+
+    if(*pcString == '\0')
+    {
+        return(false);
+    }
+    for(; *pcString; pcString++)
+    {
+        if((*pcString < '0') || (*pcString > '9') ||
+           (ui32Value > ((0xFFFFFFFF - (*pcString - '0')) / 10)))
+        {
+            return(false);
+        }
+        ui32Value = (ui32Value * 10) + (*pcString - '0');
+    }
+    *pui32Value = ui32Value;
+    return(true);
+}
@@ -0,0 +1,56 @@
+#ifndef __CONSOLE_H__
+#define __CONSOLE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// A line-oriented command parser. Bytes are fed in one at a time, as they
+// arrive from the UART; a carriage return or line feed ends the line, which
+// is split into words and dispatched through a table of commands. The
+// parser depends on nothing but the C library, so it can be driven from a
+// host program with canned byte streams.
+//
+//*****************************************************************************
+
+// Longest command line, and most words on one, including the command.
+#define CONSOLE_LINE_SIZE          40
+#define CONSOLE_MAX_ARGS           4
+
+// Results of ConsoleFeed() and ConsoleProcess(). A command returns
+// CONSOLE_OK or CONSOLE_BAD_ARGS.
+#define CONSOLE_PENDING            1   // line not finished yet
+#define CONSOLE_OK                 0
+#define CONSOLE_EMPTY              (-1) // blank line, nothing run
+#define CONSOLE_BAD_CMD            (-2)
+#define CONSOLE_TOO_MANY_ARGS      (-3)
+#define CONSOLE_TOO_LONG           (-4)
+#define CONSOLE_BAD_ARGS           (-5)
+
+typedef struct
+{
+    const char *pcCmd;
+    int (*pfnCmd)(int argc, char *argv[]);
+    const char *pcHelp;
+}
+tConsoleCommand;
+
+typedef struct
+{
+    const tConsoleCommand *psCommands;
+    uint32_t ui32NumCommands;
+    char pcLine[CONSOLE_LINE_SIZE];
+    uint32_t ui32Len;
+    bool bOverflow;
+}
+tConsole;
+
+extern void ConsoleInit(tConsole *psConsole,
+                        const tConsoleCommand *psCommands,
+                        uint32_t ui32NumCommands);
+extern int ConsoleFeed(tConsole *psConsole, char cChar);
+extern int ConsoleProcess(tConsole *psConsole, char *pcLine);
+extern bool ConsoleNumber(const char *pcString, uint32_t *pui32Value);
+
+#endif // __CONSOLE_H__
@@ -1,8 +1,13 @@
 #include <stdint.h>
+#if defined(BSP_HOST_SIM)
+#include "bsp_sim.h"                // registers backed by the host model
+#else
 #include "inc/tm4c123gh6pm.h"
+#endif
 #include "bsp.h"
 
 /****** BSP Timer ******/
+static uint32_t ClockFrequency = 16000000; // cycles/second
 void BSP_Clock_InitFastest(void){
   // 0) configure the system to use RCC2 for advanced features
   //    such as 400 MHz PLL and non-integer System Clock Divisor
@@ -24,12 +29,57 @@ void BSP_Clock_InitFastest(void){
   while((SYSCTL_RIS_R&SYSCTL_RIS_PLLLRIS)==0){};
   // 6) enable use of PLL by clearing BYPASS
   SYSCTL_RCC2_R &= ~SYSCTL_RCC2_BYPASS2;
-  //ClockFrequency = 80000000;
+  ClockFrequency = 80000000;
 }
+// Record the bus clock when it was configured somewhere else (e.g. by
+// ROM_SysCtlClockSet), so rate-dependent peripherals are set up correctly.
+void BSP_Clock_SetFrequency(uint32_t freq){
+  ClockFrequency = freq;
+}
+uint32_t BSP_Clock_GetFrequency(void){
+  return ClockFrequency;
+}
+
 
+/****** Critical sections *******/
+// Save PRIMASK and disable interrupts; restore the saved state afterwards.
+// Used around data shared between tasks and ISRs.
+#if defined(ccs)
+#define StartCritical()    _disable_IRQ()
+#define EndCritical(sr)    _restore_interrupts(sr)
+#elif defined(BSP_HOST_SIM)
+#define StartCritical()    SimDisableInterrupts()
+#define EndCritical(sr)    SimRestoreInterrupts(sr)
+#else
+static uint32_t StartCritical(void){
+  uint32_t sr;
+  __asm volatile(" mrs %0, PRIMASK\n"
+                 " cpsid i\n" : "=r"(sr) :: "memory");
+  return sr;
+}
+static void EndCritical(uint32_t sr){
+  __asm volatile(" msr PRIMASK, %0\n" :: "r"(sr) : "memory");
+}
+#endif
 
 /****** I2C *******/
-#define MAXRETRIES              5  // number of receive attempts before giving up
+#define MAXRETRIES              5  // number of attempts before giving up on a transaction
+#define I2C_PRIORITY            5  // completion callbacks may call FreeRTOS FromISR functions
+static uint32_t I2CSpeed = I2C_SPEED_STANDARD; // requested SCL frequency, bps
+static volatile int I2CNewSpeed;   // 1 = MTPR must be rewritten before the next transaction
+// SCL period = 2*(SCL_LP+SCL_HP)*(TPR+1) = 20*(TPR+1) bus clocks. Round TPR
+// up so the bus never runs faster than requested (e.g. 400 kbps at 50 MHz
+// gives TPR=6, 357 kbps).
+static uint32_t i2ctpr(uint32_t speed){
+  uint32_t tpr = (ClockFrequency+20*speed-1)/(20*speed);
+  if(tpr > 0){
+    tpr = tpr - 1;
+  }
+  if(tpr > 127){
+    tpr = 127;                     // TPR is 7 bits
+  }
+  return tpr;
+}
 void static i2cinit(void){
   SYSCTL_RCGCI2C_R |= 0x0002;      // 1a) activate clock for I2C1
   SYSCTL_RCGCGPIO_R |= 0x0001;     // 1b) activate clock for Port A
@@ -42,134 +92,222 @@ void static i2cinit(void){
   GPIO_PORTA_AFSEL_R |= 0xC0;      // 6) enable alt funct on PA7-6
   GPIO_PORTA_DEN_R |= 0xC0;        // 7) enable digital I/O on PA7-6
   I2C1_MCR_R = I2C_MCR_MFE;        // 8) master function enable
-  I2C1_MTPR_R = 39;                // 9) configure for 100 kbps clock
-  // 20*(TPR+1)*12.5ns = 10us, with TPR=39
+  I2C1_MTPR_R = i2ctpr(I2CSpeed);  // 9) configure for I2CSpeed from the bus clock
+  I2CNewSpeed = 0;
+  I2C1_MICR_R = I2C_MICR_IC;       // 10) clear any stale master interrupt
+  I2C1_MIMR_R = I2C_MIMR_IM;       // 11) arm master interrupt
+                                   // 12) I2C1 is interrupt number 37
+  NVIC_PRI9_R = (NVIC_PRI9_R&0xFFFF00FF)|(I2C_PRIORITY<<13);
+  NVIC_EN1_R = 1<<(37-32);         // 13) enable IRQ 37 in NVIC
 }
 
-uint16_t static I2C_Send1(int8_t slave, uint8_t data1){
-  while(I2C1_MCS_R&I2C_MCS_BUSY){};// wait for I2C ready
-  I2C1_MSA_R = (slave<<1)&0xFE;    // MSA[7:1] is slave address
-  I2C1_MSA_R &= ~0x01;             // MSA[0] is 0 for send
-  I2C1_MDR_R = data1&0xFF;         // prepare first byte
-  I2C1_MCS_R = (0
-//                       & ~I2C_MCS_ACK     // no data ack (no data on send)
+// Transaction engine. Callers queue I2CTransaction_t descriptors with
+// BSP_I2C_Submit(); I2C1_Handler() moves one byte per interrupt, so the CPU
+// is free while the bus runs at 100 kbps. The head of the queue is the
+// transaction on the bus. A transaction writes wlen bytes, then, if rlen is
+// nonzero, issues a repeated start and reads rlen bytes.
+static I2CTransaction_t *I2CHead;  // transaction on the bus, 0 if idle
+static I2CTransaction_t *I2CTail;  // last queued transaction
+static uint8_t I2CIndex;           // bytes of the current phase already transferred
+static int I2CReading;             // 0 = write phase; 1 = read phase
+static int I2CStopSent;            // 1 = the last command included STOP
+static uint32_t I2CTries;          // attempts made on I2CHead
+static uint16_t I2CError;          // error bits of a failed attempt, kept until its STOP is done
+static void i2cstartread(I2CTransaction_t *t){
+  I2CReading = 1;
+  I2CIndex = 0;
+  I2C1_MSA_R = ((t->slave<<1)&0xFE)|0x01;// MSA[0] is 1 for receive
+  if(t->rlen == 1){
+    I2CStopSent = 1;
+    I2C1_MCS_R = (0
+//                       & ~I2C_MCS_ACK     // negative data ack (last byte)
                        | I2C_MCS_STOP     // generate stop
                        | I2C_MCS_START    // generate start/restart
                        | I2C_MCS_RUN);    // master enable
-  while(I2C1_MCS_R&I2C_MCS_BUSY){};// wait for transmission done
-                                          // return error bits
-  return (I2C1_MCS_R&(I2C_MCS_DATACK|I2C_MCS_ADRACK|I2C_MCS_ERROR));
-}
-
-uint16_t static I2C_Send2(int8_t slave, uint8_t data1, uint8_t data2){
-  while(I2C1_MCS_R&I2C_MCS_BUSY){};// wait for I2C ready
-  I2C1_MSA_R = (slave<<1)&0xFE;    // MSA[7:1] is slave address
-  I2C1_MSA_R &= ~0x01;             // MSA[0] is 0 for send
-  I2C1_MDR_R = data1&0xFF;         // prepare first byte
-  I2C1_MCS_R = (0
-//                       & ~I2C_MCS_ACK     // no data ack (no data on send)
+  } else{
+    I2CStopSent = 0;
+    I2C1_MCS_R = (0
+                       | I2C_MCS_ACK      // positive data ack
 //                       & ~I2C_MCS_STOP    // no stop
                        | I2C_MCS_START    // generate start/restart
                        | I2C_MCS_RUN);    // master enable
-  while(I2C1_MCS_R&I2C_MCS_BUSY){};// wait for transmission done
-                                          // check error bits
-  if((I2C1_MCS_R&(I2C_MCS_DATACK|I2C_MCS_ADRACK|I2C_MCS_ERROR)) != 0){
-    I2C1_MCS_R = (0                // send stop if nonzero
-//                       & ~I2C_MCS_ACK     // no data ack (no data on send)
-                       | I2C_MCS_STOP     // stop
-//                       & ~I2C_MCS_START   // no start/restart
-//                       & ~I2C_MCS_RUN     // master disable
-                        );
-                                          // return error bits if nonzero
-    return (I2C1_MCS_R&(I2C_MCS_DATACK|I2C_MCS_ADRACK|I2C_MCS_ERROR));
   }
-  I2C1_MDR_R = data2&0xFF;         // prepare second byte
-  I2C1_MCS_R = (0
-//                       & ~I2C_MCS_ACK     // no data ack (no data on send)
-                       | I2C_MCS_STOP     // generate stop
-//                       & ~I2C_MCS_START   // no start/restart
-                       | I2C_MCS_RUN);    // master enable
-  while(I2C1_MCS_R&I2C_MCS_BUSY){};// wait for transmission done
-                                          // return error bits
-  return (I2C1_MCS_R&(I2C_MCS_DATACK|I2C_MCS_ADRACK|I2C_MCS_ERROR));
 }
-
-uint16_t static I2C_Send3(int8_t slave, uint8_t data1, uint8_t data2, uint8_t data3){
-  while(I2C1_MCS_R&I2C_MCS_BUSY){};// wait for I2C ready
-  I2C1_MSA_R = (slave<<1)&0xFE;    // MSA[7:1] is slave address
-  I2C1_MSA_R &= ~0x01;             // MSA[0] is 0 for send
-  I2C1_MDR_R = data1&0xFF;         // prepare first byte
+static void i2cstart(void){
+  I2CTransaction_t *t = I2CHead;
+  if(I2CNewSpeed){
+    I2C1_MTPR_R = i2ctpr(I2CSpeed);// bus is idle between transactions
+    I2CNewSpeed = 0;
+  }
+  if(t->wlen == 0){
+    i2cstartread(t);
+    return;
+  }
+  I2CReading = 0;
+  I2CIndex = 0;
+  I2C1_MSA_R = (t->slave<<1)&0xFE; // MSA[7:1] is slave address, MSA[0] is 0 for send
+  I2C1_MDR_R = t->wdata[0];        // prepare first byte
+  I2CStopSent = (t->wlen == 1)&&(t->rlen == 0);
   I2C1_MCS_R = (0
 //                       & ~I2C_MCS_ACK     // no data ack (no data on send)
-//                       & ~I2C_MCS_STOP    // no stop
+                       | (I2CStopSent ? I2C_MCS_STOP : 0)
                        | I2C_MCS_START    // generate start/restart
                        | I2C_MCS_RUN);    // master enable
-  while(I2C1_MCS_R&I2C_MCS_BUSY){};// wait for transmission done
-                                          // check error bits
-  if((I2C1_MCS_R&(I2C_MCS_DATACK|I2C_MCS_ADRACK|I2C_MCS_ERROR)) != 0){
-    I2C1_MCS_R = (0                // send stop if nonzero
-//                       & ~I2C_MCS_ACK     // no data ack (no data on send)
-                       | I2C_MCS_STOP     // stop
-//                       & ~I2C_MCS_START   // no start/restart
-//                       & ~I2C_MCS_RUN     // master disable
-                       );
-                                          // return error bits if nonzero
-    return (I2C1_MCS_R&(I2C_MCS_DATACK|I2C_MCS_ADRACK|I2C_MCS_ERROR));
+}
+// BSP_I2C_Submit() may run from any ISR that preempts this one (or the
+// polled handler in i2cwait()), so the dequeue and restart are done with
+// interrupts disabled; otherwise an append to I2CTail could be lost.
+static void i2cfinish(uint16_t status){
+  I2CTransaction_t *t = I2CHead;
+  uint32_t sr;
+  sr = StartCritical();
+  I2CHead = t->next;               // dequeue, then put the next one on the bus
+  if(I2CHead){
+    I2CTries = 0;
+    i2cstart();
   }
-  I2C1_MDR_R = data2&0xFF;         // prepare second byte
-  I2C1_MCS_R = (0
+  EndCritical(sr);
+  t->status = status;              // t may be reused from here on
+  if(t->done){
+    (*t->done)(t);
+  }
+}
+void BSP_I2C_Submit(I2CTransaction_t *t){
+  uint32_t sr;
+  t->status = I2C_PENDING;
+  t->next = 0;
+  sr = StartCritical();
+  if(I2CHead == 0){
+    I2CHead = I2CTail = t;         // bus is idle, start now
+    I2CTries = 0;
+    i2cstart();
+  } else{
+    I2CTail->next = t;             // runs after the ones already queued
+    I2CTail = t;
+  }
+  EndCritical(sr);
+}
+int BSP_I2C_Busy(void){
+  return I2CHead != 0;             // queue is emptied by I2C1_Handler()
+}
+uint32_t BSP_I2C_SetSpeed(uint32_t speed){
+  if(speed < I2C_SPEED_STANDARD){
+    speed = I2C_SPEED_STANDARD;
+  }
+  if(speed > I2C_SPEED_FASTPLUS){
+    speed = I2C_SPEED_FASTPLUS;
+  }
+  I2CSpeed = speed;
+  I2CNewSpeed = 1;                 // takes effect at the next transaction
+  return ClockFrequency/(20*(i2ctpr(speed)+1));
+}
+void I2C1_Handler(void){
+  I2CTransaction_t *t = I2CHead;
+  uint32_t mcs;
+  uint16_t status;
+  if((I2C1_MRIS_R&I2C_MRIS_RIS) == 0){
+    return;                        // nothing completed (see i2cwait())
+  }
+  I2C1_MICR_R = I2C_MICR_IC;       // acknowledge
+  if(t == 0){
+    return;
+  }
+  mcs = I2C1_MCS_R;
+  if((I2CError == 0)&&(mcs&(I2C_MCS_ERROR|I2C_MCS_ARBLST))){
+    I2CError = mcs&(I2C_MCS_DATACK|I2C_MCS_ADRACK|I2C_MCS_ERROR|I2C_MCS_ARBLST);
+    if((I2CStopSent == 0)&&((mcs&I2C_MCS_ARBLST) == 0)){
+      I2CStopSent = 1;
+      I2C1_MCS_R = I2C_MCS_STOP;   // release the bus; retry when the STOP is done
+      return;
+    }
+  }
+  if(I2CError){
+    status = I2CError;
+    I2CError = 0;
+    I2CTries = I2CTries + 1;
+    if(I2CTries < MAXRETRIES){
+      i2cstart();                  // repeat if error
+    } else{
+      i2cfinish(status);
+    }
+    return;
+  }
+  if(I2CReading == 0){
+    I2CIndex = I2CIndex + 1;
+    if(I2CIndex < t->wlen){
+      I2C1_MDR_R = t->wdata[I2CIndex];// prepare next byte
+      I2CStopSent = (I2CIndex == t->wlen-1)&&(t->rlen == 0);
+      I2C1_MCS_R = (0
 //                       & ~I2C_MCS_ACK     // no data ack (no data on send)
-//                       & ~I2C_MCS_STOP    // no stop
+                       | (I2CStopSent ? I2C_MCS_STOP : 0)
 //                       & ~I2C_MCS_START   // no start/restart
                        | I2C_MCS_RUN);    // master enable
-  while(I2C1_MCS_R&I2C_MCS_BUSY){};// wait for transmission done
-                                          // check error bits
-  if((I2C1_MCS_R&(I2C_MCS_DATACK|I2C_MCS_ADRACK|I2C_MCS_ERROR)) != 0){
-    I2C1_MCS_R = (0                // send stop if nonzero
-//                       & ~I2C_MCS_ACK     // no data ack (no data on send)
-                       | I2C_MCS_STOP     // stop
-//                       & ~I2C_MCS_START   // no start/restart
-//                       & ~I2C_MCS_RUN   // master disable
-                        );
-                                          // return error bits if nonzero
-    return (I2C1_MCS_R&(I2C_MCS_DATACK|I2C_MCS_ADRACK|I2C_MCS_ERROR));
-  }
-  I2C1_MDR_R = data3&0xFF;         // prepare third byte
-  I2C1_MCS_R = (0
-//                       & ~I2C_MCS_ACK     // no data ack (no data on send)
-                       | I2C_MCS_STOP     // generate stop
+      return;
+    }
+    if(t->rlen > 0){
+      i2cstartread(t);             // repeated start for the read phase
+      return;
+    }
+  } else{
+    t->rdata[I2CIndex] = I2C1_MDR_R&0xFF;
+    I2CIndex = I2CIndex + 1;
+    if(I2CIndex < t->rlen){
+      I2CStopSent = (I2CIndex == t->rlen-1);
+      I2C1_MCS_R = (0
+                       | (I2CStopSent ? 0 : I2C_MCS_ACK) // negative data ack on the last byte
+                       | (I2CStopSent ? I2C_MCS_STOP : 0)
 //                       & ~I2C_MCS_START   // no start/restart
                        | I2C_MCS_RUN);    // master enable
-  while(I2C1_MCS_R&I2C_MCS_BUSY){};// wait for transmission done
-                                          // return error bits
-  return (I2C1_MCS_R&(I2C_MCS_DATACK|I2C_MCS_ADRACK|I2C_MCS_ERROR));
+      return;
+    }
+  }
+  i2cfinish(0);
+}
+
+// Blocking helpers built on the engine. If the I2C interrupt cannot be taken
+// (for example, FreeRTOS masks it until the scheduler starts) the handler is
+// run from here instead, with IRQ 37 held off so it cannot re-enter itself.
+static void i2cwait(I2CTransaction_t *t){
+  while(t->status == I2C_PENDING){
+    NVIC_DIS1_R = 1<<(37-32);
+    I2C1_Handler();
+    NVIC_EN1_R = 1<<(37-32);
+  }
+}
+static void i2cwrite(I2CTransaction_t *t, int8_t slave, uint8_t wlen, uint8_t data1, uint8_t data2, uint8_t data3){
+  t->slave = slave;
+  t->wlen = wlen;
+  t->rlen = 0;
+  t->wdata[0] = data1;
+  t->wdata[1] = data2;
+  t->wdata[2] = data3;
+  t->done = 0;
+}
+
+uint16_t static I2C_Send1(int8_t slave, uint8_t data1){
+  I2CTransaction_t t;
+  i2cwrite(&t, slave, 1, data1, 0, 0);
+  BSP_I2C_Submit(&t);
+  i2cwait(&t);                     // return error bits
+  return t.status;
+}
+
+uint16_t static I2C_Send3(int8_t slave, uint8_t data1, uint8_t data2, uint8_t data3){
+  I2CTransaction_t t;
+  i2cwrite(&t, slave, 3, data1, data2, data3);
+  BSP_I2C_Submit(&t);
+  i2cwait(&t);                     // return error bits
+  return t.status;
 }
 
 uint16_t static I2C_Recv2(int8_t slave){
-  uint8_t data1,data2;
-  int retryCounter = 1;
-  do{
-    while(I2C1_MCS_R&I2C_MCS_BUSY){};// wait for I2C ready
-    I2C1_MSA_R = (slave<<1)&0xFE;    // MSA[7:1] is slave address
-    I2C1_MSA_R |= 0x01;              // MSA[0] is 1 for receive
-    I2C1_MCS_R = (0
-                         | I2C_MCS_ACK      // positive data ack
- //                        & ~I2C_MCS_STOP    // no stop
-                         | I2C_MCS_START    // generate start/restart
-                         | I2C_MCS_RUN);    // master enable
-    while(I2C1_MCS_R&I2C_MCS_BUSY){};// wait for transmission done
-    data1 = (I2C1_MDR_R&0xFF);       // MSB data sent first
-    I2C1_MCS_R = (0
-//                         & ~I2C_MCS_ACK     // negative data ack (last byte)
-                         | I2C_MCS_STOP     // generate stop
-//                         & ~I2C_MCS_START   // no start/restart
-                         | I2C_MCS_RUN);    // master enable
-    while(I2C1_MCS_R&I2C_MCS_BUSY){};// wait for transmission done
-    data2 = (I2C1_MDR_R&0xFF);       // LSB data sent last
-    retryCounter = retryCounter + 1;        // increment retry counter
-  }                                         // repeat if error
-  while(((I2C1_MCS_R&(I2C_MCS_ADRACK|I2C_MCS_ERROR)) != 0) && (retryCounter <= MAXRETRIES));
-  return (data1<<8)+data2;                  // usually returns 0xFFFF on error
+  I2CTransaction_t t;
+  i2cwrite(&t, slave, 0, 0, 0, 0);
+  t.rlen = 2;
+  t.rdata[0] = t.rdata[1] = 0xFF;
+  BSP_I2C_Submit(&t);
+  i2cwait(&t);
+  return (t.rdata[0]<<8)+t.rdata[1];// usually returns 0xFFFF on error
 }
 
 /****** ACCELEROMETER *******/
@@ -209,6 +347,296 @@ void BSP_Accelerometer_Input(uint16_t *x, uint16_t *y, uint16_t *z){
   ADC0_ISC_R = 0x0004;             // 4) acknowledge completion
 }
 
+// Interrupt-driven sampling. BSP_Accelerometer_Start() triggers SS2 and
+// returns immediately; ADC0Seq2_Handler() drains the FIFO when the third
+// conversion completes and then calls the user task (from the ISR).
+#define ACCEL_MODE_SINGLE 0        // one SS2 conversion per BSP_Accelerometer_Start()
+#define ACCEL_MODE_TIMER  1        // Timer0A triggers SS2 at a fixed rate into blocks
+#define ACCEL_MODE_DMA    2        // as TIMER, but uDMA moves the samples into the blocks
+static int AccelMode = ACCEL_MODE_SINGLE;
+#define ACCEL_IDLE    0            // no conversion requested
+#define ACCEL_BUSY    1            // SS2 triggered, waiting for ADC0Seq2_Handler()
+#define ACCEL_READY   2            // x,y,z latched, waiting for BSP_Accelerometer_End()
+static volatile int AccelState = ACCEL_IDLE;
+static volatile uint16_t AccelX, AccelY, AccelZ;
+static void (*AccelTask)(void);    // called from ISR when a sample is ready
+void BSP_Accelerometer_InitInterrupt(void(*task)(void), uint32_t priority){
+  if(priority > 7){
+    priority = 7;
+  }
+  AccelTask = task;
+  AccelState = ACCEL_IDLE;
+  AccelMode = ACCEL_MODE_SINGLE;
+  ADC0_ISC_R = 0x0004;             // 1) clear any stale SS2 completion
+  ADC0_IM_R |= 0x0004;             // 2) enable SS2 interrupts
+                                   // 3) ADC0 SS2 is interrupt number 16
+  NVIC_PRI4_R = (NVIC_PRI4_R&0xFFFFFF00)|(priority<<5);
+  NVIC_EN0_R = 1<<16;              // 4) enable IRQ 16 in NVIC
+}
+void BSP_Accelerometer_Start(void){
+  if(AccelState == ACCEL_IDLE){
+    AccelState = ACCEL_BUSY;
+    ADC0_PSSI_R = 0x0004;          // initiate SS2; ADC0Seq2_Handler() finishes it
+  }
+}
+int BSP_Accelerometer_End(uint16_t *x, uint16_t *y, uint16_t *z){
+  if(AccelState != ACCEL_READY){
+    return 0;                      // conversion needs more time to complete
+  }
+  *x = AccelX;
+  *y = AccelY;
+  *z = AccelZ;
+  AccelState = ACCEL_IDLE;
+  return 1;                        // sample is complete; pointers valid
+}
+
+// Fixed-rate sampling. Timer0A is a periodic ADC trigger, so every sample
+// is taken on the timer edge regardless of how busy the consumer is. The
+// ISR packs x,y,z triplets into one of two blocks; when a block is full it
+// is handed to the consumer and the ISR moves on to the other block.
+static uint16_t AccelBlock[2][3*ACCEL_BLOCK_SAMPLES];
+static volatile int AccelBlockFull[2]; // 1 = owned by the consumer
+static int AccelWriteBlock;        // block the ISR is filling
+static uint32_t AccelWriteCount;   // triplets already in AccelWriteBlock
+static int AccelReadBlock;         // next block BSP_Accelerometer_GetBlock() returns
+static volatile uint32_t AccelOverruns; // samples dropped because both blocks were full
+static uint32_t timerperiod(uint32_t freq){
+  if(freq < ACCEL_RATE_MIN){
+    freq = ACCEL_RATE_MIN;
+  }
+  if(freq > ACCEL_RATE_MAX){
+    freq = ACCEL_RATE_MAX;
+  }
+  return ClockFrequency/freq - 1;
+}
+static void accelblockinit(void(*task)(void), int mode){
+  AccelTask = task;
+  AccelMode = mode;
+  AccelBlockFull[0] = AccelBlockFull[1] = 0;
+  AccelWriteBlock = AccelReadBlock = 0;
+  AccelWriteCount = 0;
+  AccelOverruns = 0;
+}
+static void adctimerinit(uint32_t freq){
+  SYSCTL_RCGCTIMER_R |= 0x01;      // 1) activate clock for Timer0
+  while((SYSCTL_PRTIMER_R&0x01) == 0){};// allow time for clock to stabilize
+  TIMER0_CTL_R = 0x00000000;       // 2) disable Timer0A during setup
+  TIMER0_CFG_R = TIMER_CFG_32_BIT_TIMER; // 3) 32-bit mode
+  TIMER0_TAMR_R = TIMER_TAMR_TAMR_PERIOD;// 4) periodic mode, down-count
+  TIMER0_TAPR_R = 0;               // 5) bus clock resolution
+  TIMER0_TAILR_R = timerperiod(freq);// 6) reload value
+  TIMER0_IMR_R = 0x00000000;       // 7) no timer interrupts; it only triggers the ADC
+  ADC0_ACTSS_R &= ~0x0004;         // 8) disable sample sequencer 2
+  ADC0_EMUX_R = (ADC0_EMUX_R&~ADC_EMUX_EM2_M)|ADC_EMUX_EM2_TIMER; // 9) seq2 is timer trigger
+  ADC0_ISC_R = 0x0004;             // 10) clear any stale SS2 completion
+}
+static void adcinterruptenable(uint32_t priority){
+  if(priority > 7){
+    priority = 7;
+  }
+                                   // ADC0 SS2 is interrupt number 16
+  NVIC_PRI4_R = (NVIC_PRI4_R&0xFFFFFF00)|(priority<<5);
+  NVIC_EN0_R = 1<<16;              // enable IRQ 16 in NVIC
+}
+void BSP_Accelerometer_InitTimer(uint32_t freq, void(*task)(void), uint32_t priority){
+  accelblockinit(task, ACCEL_MODE_TIMER);
+  adctimerinit(freq);              // 1-10) Timer0A triggers SS2
+  ADC0_IM_R |= 0x0004;             // 11) enable SS2 interrupts
+  ADC0_ACTSS_R |= 0x0004;          // 12) enable sample sequencer 2
+  adcinterruptenable(priority);    // 13) ADC0 SS2 interrupt in NVIC
+  TIMER0_CTL_R = TIMER_CTL_TAOTE|TIMER_CTL_TAEN; // 14) enable Timer0A with ADC trigger
+}
+
+// DMA streaming. uDMA channel 16 (ADC0 SS2) runs in ping-pong mode from
+// ADC0_SSFIFO2_R into the same two blocks: the primary control structure
+// fills block 0 and the alternate fills block 1. The uDMA completion
+// interrupt arrives on the ADC0 SS2 vector once per block, where the
+// finished half is re-armed and handed to the consumer, so there is no
+// CPU work per sample. The consumer must release a block within one block
+// period; after that the DMA overwrites it and the samples count as overruns.
+#define ACCEL_DMA_CH     16        // ADC0 SS2 is uDMA channel 16, encoding 0
+#define ACCEL_DMA_PRI    (4*ACCEL_DMA_CH)      // primary control word index
+#define ACCEL_DMA_ALT    (128+4*ACCEL_DMA_CH)  // alternate control word index
+#define ACCEL_DMA_CTL    (UDMA_CHCTL_DSTINC_16|UDMA_CHCTL_DSTSIZE_16| \
+                          UDMA_CHCTL_SRCINC_NONE|UDMA_CHCTL_SRCSIZE_16| \
+                          UDMA_CHCTL_ARBSIZE_1| \
+                          ((3*ACCEL_BLOCK_SAMPLES-1)<<4)| \
+                          UDMA_CHCTL_XFERMODE_PINGPONG)
+#define ACCEL_DMA_SRC    0x40038088  // &ADC0_SSFIFO2_R, the source end pointer
+// Bus address the controller is given for p. The host model cannot take
+// 64-bit pointers, so it hands out 32-bit stand-ins and maps them back.
+#if defined(BSP_HOST_SIM)
+#define DMAADDR(p)       SimDMAAddress((void *)(p))
+#else
+#define DMAADDR(p)       ((uint32_t)(uintptr_t)(p))
+#endif
+// uDMA control table: 32 primary + 32 alternate entries of 4 words each,
+// which the controller requires to be 1024-byte aligned.
+#if defined(ccs)
+#pragma DATA_ALIGN(DMAControlTable, 1024)
+static uint32_t DMAControlTable[256];
+#else
+static uint32_t DMAControlTable[256] __attribute__ ((aligned(1024)));
+#endif
+static void dmaarm(int index, uint16_t *block){
+  DMAControlTable[index] = ACCEL_DMA_SRC;                          // source end pointer
+  DMAControlTable[index+1] = DMAADDR(&block[3*ACCEL_BLOCK_SAMPLES-1]);// destination end pointer
+  DMAControlTable[index+2] = ACCEL_DMA_CTL;                        // control word
+}
+// Caller-supplied blocks. Instead of cycling through AccelBlock[], each
+// half is re-armed with a fresh block from getblock() and the finished one
+// is passed to done(); both run in the ISR. If getblock() has nothing, the
+// finished block is refilled and its samples count as overruns.
+static uint16_t *(*AccelGetBlock)(void);
+static void (*AccelDone)(uint16_t *block);
+static uint16_t *AccelDMABlock[2]; // blocks the primary and alternate structures fill
+static void dmainit(uint32_t freq, uint32_t priority);
+void BSP_Accelerometer_InitDMA(uint32_t freq, void(*task)(void), uint32_t priority){
+  accelblockinit(task, ACCEL_MODE_DMA);
+  AccelDone = 0;
+  AccelDMABlock[0] = AccelBlock[0];
+  AccelDMABlock[1] = AccelBlock[1];
+  dmainit(freq, priority);
+}
+void BSP_Accelerometer_InitDMABlocks(uint32_t freq, uint16_t *(*getblock)(void),
+                                     void(*done)(uint16_t *block), uint32_t priority){
+  accelblockinit(0, ACCEL_MODE_DMA);
+  AccelGetBlock = getblock;
+  AccelDone = done;
+  AccelDMABlock[0] = getblock();
+  AccelDMABlock[1] = getblock();
+  if(AccelDMABlock[0] == 0){
+    AccelDMABlock[0] = AccelBlock[0];// never handed on while the pool is short
+  }
+  if(AccelDMABlock[1] == 0){
+    AccelDMABlock[1] = AccelBlock[1];
+  }
+  dmainit(freq, priority);
+}
+static void dmainit(uint32_t freq, uint32_t priority){
+  SYSCTL_RCGCDMA_R |= 0x01;        // 1) activate clock for uDMA
+  while((SYSCTL_PRDMA_R&0x01) == 0){};// allow time for clock to stabilize
+  UDMA_CFG_R = UDMA_CFG_MASTEN;    // 2) enable the uDMA controller
+  UDMA_CTLBASE_R = DMAADDR(DMAControlTable); // 3) control table location
+  UDMA_CHMAP2_R &= ~UDMA_CHMAP2_CH16SEL_M;    // 4) channel 16 is ADC0 SS2
+  UDMA_PRIOCLR_R = 1<<ACCEL_DMA_CH;// 5) default priority
+  UDMA_ALTCLR_R = 1<<ACCEL_DMA_CH; // 6) start with the primary structure
+  UDMA_USEBURSTCLR_R = 1<<ACCEL_DMA_CH;// 7) respond to single and burst requests
+  UDMA_REQMASKCLR_R = 1<<ACCEL_DMA_CH; // 8) allow ADC requests
+  dmaarm(ACCEL_DMA_PRI, AccelDMABlock[0]);// 9) primary fills block 0
+  dmaarm(ACCEL_DMA_ALT, AccelDMABlock[1]);//    alternate fills block 1
+  UDMA_CHIS_R = 1<<ACCEL_DMA_CH;   // 10) clear stale completion
+  UDMA_ENASET_R = 1<<ACCEL_DMA_CH; // 11) enable the channel
+  adctimerinit(freq);              // 12-21) Timer0A triggers SS2
+  ADC0_IM_R &= ~0x0004;            // 22) only the DMA completion interrupts, not each sequence
+  ADC0_ACTSS_R |= 0x0004;          // 23) enable sample sequencer 2
+  adcinterruptenable(priority);    // 24) ADC0 SS2 interrupt in NVIC
+  TIMER0_CTL_R = TIMER_CTL_TAOTE|TIMER_CTL_TAEN; // 25) enable Timer0A with ADC trigger
+}
+static void dmablockswap(int index, int half){
+  uint16_t *full = AccelDMABlock[half];
+  uint16_t *next = AccelGetBlock();
+  if(next){
+    AccelDMABlock[half] = next;
+  }
+  dmaarm(index, AccelDMABlock[half]);// with no new block, refill the old one
+  if((next == 0)||(full == AccelBlock[half])){
+    // nothing to hand on: the block is being refilled, or it is the
+    // spare, which never leaves the BSP
+    AccelOverruns = AccelOverruns + ACCEL_BLOCK_SAMPLES;
+    return;
+  }
+  (*AccelDone)(full);              // the consumer owns it from now on
+}
+static void dmablockdone(int block){
+  if(AccelBlockFull[block^1]){
+    // DMA has moved on into a block the consumer still holds
+    AccelOverruns = AccelOverruns + ACCEL_BLOCK_SAMPLES;
+  }
+  AccelBlockFull[block] = 1;       // hand the block to the consumer
+}
+void BSP_Accelerometer_SetRate(uint32_t freq){
+  TIMER0_TAILR_R = timerperiod(freq);// takes effect at the next time-out
+}
+void BSP_Accelerometer_StopTimer(void){
+  TIMER0_CTL_R = 0x00000000;       // no more triggers; blocks already full stay valid
+}
+const uint16_t *BSP_Accelerometer_GetBlock(void){
+  if(AccelBlockFull[AccelReadBlock] == 0){
+    return 0;                      // no complete block yet
+  }
+  return AccelBlock[AccelReadBlock];
+}
+void BSP_Accelerometer_ReleaseBlock(void){
+  AccelBlockFull[AccelReadBlock] = 0; // give the block back to the ISR
+  AccelReadBlock ^= 1;
+}
+uint32_t BSP_Accelerometer_Overruns(void){
+  return AccelOverruns;
+}
+int BSP_Accelerometer_Busy(void){
+  if(AccelState == ACCEL_BUSY){
+    return 1;                      // single conversion in flight
+  }
+  if((SYSCTL_RCGCTIMER_R&0x01) == 0){
+    return 0;                      // Timer0 never clocked; touching it would bus fault
+  }
+  return (TIMER0_CTL_R&TIMER_CTL_TAEN) != 0; // Timer0A still triggering SS2
+}
+
+void ADC0Seq2_Handler(void){
+  uint16_t *p;
+  ADC0_ISC_R = 0x0004;             // acknowledge completion
+  if(AccelMode == ACCEL_MODE_SINGLE){
+    AccelX = ADC0_SSFIFO2_R>>2;    // read first result
+    AccelY = ADC0_SSFIFO2_R>>2;    // read second result
+    AccelZ = ADC0_SSFIFO2_R>>2;    // read third result
+    AccelState = ACCEL_READY;
+  } else if(AccelMode == ACCEL_MODE_DMA){
+    UDMA_CHIS_R = 1<<ACCEL_DMA_CH; // acknowledge uDMA completion
+    // a finished half has its mode field back at STOP; the controller has
+    // already switched to the other half, so re-arm this one behind it
+    if((DMAControlTable[ACCEL_DMA_PRI+2]&UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_STOP){
+      if(AccelDone){
+        dmablockswap(ACCEL_DMA_PRI, 0);
+      } else{
+        dmaarm(ACCEL_DMA_PRI, AccelBlock[0]);
+        dmablockdone(0);
+      }
+    }
+    if((DMAControlTable[ACCEL_DMA_ALT+2]&UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_STOP){
+      if(AccelDone){
+        dmablockswap(ACCEL_DMA_ALT, 1);
+      } else{
+        dmaarm(ACCEL_DMA_ALT, AccelBlock[1]);
+        dmablockdone(1);
+      }
+    }
+  } else{
+    if(AccelBlockFull[AccelWriteBlock]){
+      (void)ADC0_SSFIFO2_R;        // consumer still owns both blocks,
+      (void)ADC0_SSFIFO2_R;        // so drop this sample
+      (void)ADC0_SSFIFO2_R;
+      AccelOverruns = AccelOverruns + 1;
+      return;
+    }
+    p = &AccelBlock[AccelWriteBlock][3*AccelWriteCount];
+    p[0] = ADC0_SSFIFO2_R>>2;      // x
+    p[1] = ADC0_SSFIFO2_R>>2;      // y
+    p[2] = ADC0_SSFIFO2_R>>2;      // z
+    AccelWriteCount = AccelWriteCount + 1;
+    if(AccelWriteCount < ACCEL_BLOCK_SAMPLES){
+      return;                      // block not full yet
+    }
+    AccelBlockFull[AccelWriteBlock] = 1; // hand the block to the consumer
+    AccelWriteBlock ^= 1;
+    AccelWriteCount = 0;
+  }
+  if(AccelTask){
+    (*AccelTask)();                // notify the waiting task
+  }
+}
+
 /****** LIGHT SENSOR *******/
 void BSP_LightSensor_Init(void){
   i2cinit();
@@ -255,42 +683,224 @@ int32_t static lightsensorend(uint8_t slaveAddress){
   return (1<<(raw>>12))*(raw&0x0FFF);
 }
 
+#if defined(BSP_HOST_SIM)
+#define LIGHTINT  SIM_LIGHTINT
+#else
 #define LIGHTINT  (*((volatile uint32_t *)0x40004080))  /* PA5 */
+#endif
 int LightBusy = 0;                 // 0 = idle; 1 = measuring
+static volatile int LightReady = 0;// 1 = LightValue holds a completed measurement
+static volatile uint32_t LightValue;// last measurement, in the same units as BSP_LightSensor_Input()
+static void (*LightTask)(void);    // called from ISR when a measurement completes
 uint32_t BSP_LightSensor_Input(void){
   uint32_t light;
   LightBusy = 1;
+  GPIO_PORTA_IM_R &= ~0x20;        // this call polls, so keep the ISR out of it
   lightsensorstart(0x44);
   while(LIGHTINT == 0x20){};       // wait for conversion to complete
   light = lightsensorend(0x44);
+  LightReady = 0;
   LightBusy = 0;
   return light;
 }
 
+// Interrupt-driven completion. The OPT3001 pulls INT (PA5) low when a
+// conversion finishes, so PA5 is a falling-edge interrupt that is armed once
+// the sensor is configured and disarmed again by GPIOPortA_Handler(). Both
+// the configuration and the read-out are chains of I2C transactions whose
+// completion callbacks, running in I2C1_Handler(), queue the next step.
+static I2CTransaction_t LightI2C[4];
+static volatile int LightStopping = 0;// 1 = continuous mode is shutting down
+// 1 when none of the descriptors is still queued, so they may be reused
+static int lightidle(void){
+  int i;
+  for(i=0; i<4; i=i+1){
+    if(LightI2C[i].status == I2C_PENDING){
+      return 0;
+    }
+  }
+  return 1;
+}
+static void lightarm(I2CTransaction_t *t){
+  (void)t;
+  if(LightStopping == 0){
+    GPIO_PORTA_IM_R |= 0x20;       // configured; arm PA5 (an edge during the start is still latched)
+  }
+}
+static void lightresult(I2CTransaction_t *t){
+  uint16_t raw = (t->rdata[0]<<8)+t->rdata[1];
+  LightValue = (1<<(raw>>12))*(raw&0x0FFF);
+}
+static void lightdone(I2CTransaction_t *t){
+  (void)t;
+  LightReady = 1;
+  if(LightTask){
+    (*LightTask)();                // notify the waiting task
+  }
+}
+static void lightnext(I2CTransaction_t *t){
+  if(LightStopping){
+    return;                        // read-out queued before the stop; drop it
+  }
+  GPIO_PORTA_IM_R |= 0x20;         // Configuration read released INT; wait for the next conversion
+  lightdone(t);
+}
+static void lightlatch(I2CTransaction_t *t){
+  // force the INT pin to clear by clearing and resetting the latch bit of the Configuration Register (0x01)
+  i2cwrite(&LightI2C[2], 0x44, 3, 0x01, t->rdata[0], t->rdata[1]&~0x10);
+  i2cwrite(&LightI2C[3], 0x44, 3, 0x01, t->rdata[0], t->rdata[1]|0x10);
+  LightI2C[3].done = lightdone;
+  BSP_I2C_Submit(&LightI2C[2]);
+  BSP_I2C_Submit(&LightI2C[3]);
+}
+void BSP_LightSensor_InitInterrupt(void(*task)(void), uint32_t priority){
+  if(priority > 7){
+    priority = 7;
+  }
+  LightTask = task;
+  LightReady = 0;
+  GPIO_PORTA_IM_R &= ~0x20;        // 1) disarm PA5 until a measurement starts
+  GPIO_PORTA_IS_R &= ~0x20;        // 2) PA5 is edge-sensitive
+  GPIO_PORTA_IBE_R &= ~0x20;       // 3) PA5 is not both edges
+  GPIO_PORTA_IEV_R &= ~0x20;       // 4) PA5 falling edge event
+  GPIO_PORTA_ICR_R = 0x20;         // 5) clear flag5
+                                   // 6) GPIO Port A is interrupt number 0
+  NVIC_PRI0_R = (NVIC_PRI0_R&0xFFFFFF00)|(priority<<5);
+  NVIC_EN0_R = 1<<0;               // 7) enable IRQ 0 in NVIC
+}
+
+// same register writes as lightsensorstart(), queued instead of waited on;
+// config is the high byte of the Configuration Register
+static void lightconfigure(uint8_t config){
+  LightReady = 0;
+  GPIO_PORTA_ICR_R = 0x20;         // forget edges from earlier measurements
+  i2cwrite(&LightI2C[0], 0x44, 3, 0x02, 0xC0, 0x00);   // Low Limit Register
+  i2cwrite(&LightI2C[1], 0x44, 3, 0x01, config, 0x10); // Configuration Register
+  i2cwrite(&LightI2C[2], 0x44, 0, 0, 0, 0);            // read Configuration Register
+  LightI2C[2].rlen = 2;
+  LightI2C[2].done = lightarm;
+  BSP_I2C_Submit(&LightI2C[0]);
+  BSP_I2C_Submit(&LightI2C[1]);
+  BSP_I2C_Submit(&LightI2C[2]);
+}
+
 void BSP_LightSensor_Start(void){
-  if(LightBusy == 0){
+  if((LightBusy == 0)&&lightidle()){
     // no measurement is in progress, so start one
     LightBusy = 1;
-    lightsensorstart(0x44);
+    lightconfigure(0xCA);          // automatic range, 800 ms, single-shot
+  }
+}
+
+// Continuous conversion. The OPT3001 is configured once and then converts
+// back to back; each INT edge costs one Result read and one Configuration
+// read (which is what releases the latched INT pin), instead of the seven
+// transactions of a single-shot start and end.
+//
+// Stopping disarms PA5 and queues the shutdown write; the sensor is idle
+// once that write completes, which, as the queue runs in order, is after
+// any read-out that was already queued. A start requested in the meantime
+// is held in LightRestart and made from the shutdown's callback.
+static volatile int LightContinuous = 0;// 1 = converting continuously
+static volatile uint8_t LightRestart = 0;// Configuration high byte to start with once stopped, 0 = none
+static void lightstopped(I2CTransaction_t *t){
+  uint8_t config = LightRestart;
+  (void)t;
+  LightStopping = 0;
+  LightReady = 0;
+  LightRestart = 0;
+  if(config && lightidle()){
+    LightContinuous = 1;
+    lightconfigure(config);        // LightBusy stays 1
+  } else{
+    LightBusy = 0;
+  }
+}
+void BSP_LightSensor_StartContinuous(uint32_t convtime){
+  uint32_t sr;
+  // 15-12 RN 1100b = automatic full-scale; 11 CT; 10-9 M 11b = continuous
+  uint8_t config = (convtime == LIGHT_CONVERSION_100MS) ? 0xC6 : 0xCE;
+  sr = StartCritical();
+  if(LightStopping){
+    LightRestart = config;         // lightstopped() starts it
+    EndCritical(sr);
+    return;
+  }
+  if(LightBusy || (lightidle() == 0)){
+    EndCritical(sr);
+    return;                        // a measurement is already running
+  }
+  LightBusy = 1;
+  LightContinuous = 1;
+  EndCritical(sr);
+  lightconfigure(config);
+}
+void BSP_LightSensor_StopContinuous(void){
+  uint32_t sr;
+  sr = StartCritical();
+  if((LightContinuous == 0)||LightStopping){
+    EndCritical(sr);
+    return;
   }
+  GPIO_PORTA_IM_R &= ~0x20;        // no more read-outs from here on
+  LightContinuous = 0;
+  LightStopping = 1;
+  LightRestart = 0;
+  EndCritical(sr);
+  // Configuration Register M = 00b, shutdown
+  i2cwrite(&LightI2C[3], 0x44, 3, 0x01, 0xC8, 0x10);
+  LightI2C[3].done = lightstopped;
+  BSP_I2C_Submit(&LightI2C[3]);
 }
 
 int BSP_LightSensor_End(uint32_t *light){
-  uint32_t lightLocal;
   if(LightBusy == 0){
     // no measurement is in progress, so start one
-    LightBusy = 1;
-    lightsensorstart(0x44);
+    BSP_LightSensor_Start();
     return 0;                      // measurement needs more time to complete
-  } else{
-    // measurement is in progress
-    if(LIGHTINT == 0x20){
-      return 0;                    // measurement needs more time to complete
-    } else{
-      lightLocal = lightsensorend(0x44);
-      *light = lightLocal;
-      LightBusy = 0;
-      return 1;                    // measurement is complete; pointer valid
-    }
   }
+  if(LightReady == 0){
+    return 0;                      // measurement needs more time to complete
+  }
+  *light = LightValue;
+  LightReady = 0;
+  if(LightContinuous == 0){
+    LightBusy = 0;
+  }
+  return 1;                        // measurement is complete; pointer valid
+}
+int BSP_LightSensor_Ready(void){
+  return LightReady;
+}
+
+void GPIOPortA_Handler(void){
+  if(GPIO_PORTA_MIS_R&0x20){
+    GPIO_PORTA_ICR_R = 0x20;       // acknowledge flag5
+    GPIO_PORTA_IM_R &= ~0x20;      // disarm until this conversion has been read
+    // Result Register (0x00), then Configuration Register (0x01), each as
+    // pointer write + repeated start read; a single-shot measurement also
+    // needs lightlatch(), continuous mode simply re-arms
+    i2cwrite(&LightI2C[0], 0x44, 1, 0x00, 0, 0);
+    LightI2C[0].rlen = 2;
+    LightI2C[0].done = lightresult;
+    i2cwrite(&LightI2C[1], 0x44, 1, 0x01, 0, 0);
+    LightI2C[1].rlen = 2;
+    LightI2C[1].done = LightContinuous ? lightnext : lightlatch;
+    BSP_I2C_Submit(&LightI2C[0]);
+    BSP_I2C_Submit(&LightI2C[1]);
+  }
+}
+
+#if BENCH_MODE
+// Entry points for the benchmark (bench.c), which also times these internal
+// helpers. Each makes one representative call to the OPT3001.
+uint16_t BSP_Bench_I2C_Send3(void){
+  return I2C_Send3(0x44, 0x02, 0xC0, 0x00);// Low Limit Register, as lightsensorstart()
+}
+uint16_t BSP_Bench_I2C_Recv2(void){
+  return I2C_Recv2(0x44);
+}
+int32_t BSP_Bench_LightSensorEnd(void){
+  return lightsensorend(0x44);
 }
+#endif
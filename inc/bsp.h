@@ -8,18 +8,114 @@
 #ifndef INC_BSP_H_
 #define INC_BSP_H_
 
+// I2C1 master transaction: write wlen bytes, then, if rlen is nonzero,
+// read rlen bytes after a repeated start. status is I2C_PENDING until the
+// transaction ends, then 0 or the I2C_MCS error bits; done (may be 0) is
+// called from I2C1_Handler() right after status is set.
+#define I2C_PENDING 0x0100
+typedef struct I2CTransaction{
+  uint8_t slave;                   // 7-bit slave address
+  uint8_t wlen;                    // bytes to write, 0-4
+  uint8_t rlen;                    // bytes to read, 0-4
+  uint8_t wdata[4];
+  uint8_t rdata[4];
+  volatile uint16_t status;
+  void (*done)(struct I2CTransaction *t);
+  struct I2CTransaction *next;     // owned by the queue while pending
+} I2CTransaction_t;
+
 // BSP Timer
 void BSP_Clock_InitFastest(void);
+void BSP_Clock_SetFrequency(uint32_t freq);
+uint32_t BSP_Clock_GetFrequency(void);
+
+// I2C1 (initialized by BSP_LightSensor_Init()). Queues t, which must stay
+// valid until its status is no longer I2C_PENDING. Safe to call from tasks
+// and from any ISR: the queue is only linked and unlinked with interrupts
+// disabled.
+void BSP_I2C_Submit(I2CTransaction_t *t);
+// 1 while a transaction is queued or on the bus, so I2C1 needs its clock
+int BSP_I2C_Busy(void);
+// Set the SCL rate (clamped to 100 kbps-1 Mbps) from the bus clock given to
+// BSP_Clock_SetFrequency(). Returns the rate actually achieved, which is
+// never above the request. Takes effect at the next transaction.
+#define I2C_SPEED_STANDARD  100000
+#define I2C_SPEED_FAST      400000
+#define I2C_SPEED_FASTPLUS  1000000
+uint32_t BSP_I2C_SetSpeed(uint32_t speed);
+void I2C1_Handler(void);
 
 // Accelerometer
-static void  adcinit(void);
 void BSP_Accelerometer_Input(uint16_t *x, uint16_t *y, uint16_t *z);
 void BSP_Accelerometer_Init(void);
+// Interrupt-driven accelerometer (call after BSP_Accelerometer_Init()).
+// task runs from the ADC0 SS2 ISR at the given NVIC priority (0-7), so it
+// must only use FromISR kernel calls. Do not mix with BSP_Accelerometer_Input.
+void BSP_Accelerometer_InitInterrupt(void(*task)(void), uint32_t priority);
+void BSP_Accelerometer_Start(void);
+int BSP_Accelerometer_End(uint16_t *x, uint16_t *y, uint16_t *z);
+// Fixed-rate accelerometer (call after BSP_Accelerometer_Init()).
+// Timer0A triggers SS2 at freq Hz (clamped to ACCEL_RATE_MIN-ACCEL_RATE_MAX)
+// and samples are collected into two ping-pong blocks of ACCEL_BLOCK_SAMPLES
+// x,y,z triplets. task runs from the ISR each time a block fills.
+#define ACCEL_BLOCK_SAMPLES 16
+#define ACCEL_RATE_MIN      10
+#define ACCEL_RATE_MAX      10000
+void BSP_Accelerometer_InitTimer(uint32_t freq, void(*task)(void), uint32_t priority);
+void BSP_Accelerometer_SetRate(uint32_t freq);
+void BSP_Accelerometer_StopTimer(void);
+// Returns the oldest full block (x0,y0,z0,x1,...) or 0 if none is ready.
+// The block stays valid until BSP_Accelerometer_ReleaseBlock().
+const uint16_t *BSP_Accelerometer_GetBlock(void);
+void BSP_Accelerometer_ReleaseBlock(void);
+// Same as BSP_Accelerometer_InitTimer(), but uDMA copies each conversion
+// into the blocks and task runs once per full block, not once per sample.
+// Blocks hold the raw 12-bit conversions (shift right 2 to match the other
+// modes), and must be released within one block period.
+void BSP_Accelerometer_InitDMA(uint32_t freq, void(*task)(void), uint32_t priority);
+// Same, but the uDMA fills blocks of 3*ACCEL_BLOCK_SAMPLES codes that the
+// caller supplies, so the samples are never copied. getblock() returns an
+// empty block, or 0 if none is free; done() receives each full block, which
+// the caller then owns. Both run from the ISR. Raw 12-bit codes, as above;
+// GetBlock/ReleaseBlock are not used in this mode.
+void BSP_Accelerometer_InitDMABlocks(uint32_t freq, uint16_t *(*getblock)(void),
+                                     void(*done)(uint16_t *block), uint32_t priority);
+uint32_t BSP_Accelerometer_Overruns(void);
+// 1 while ADC0 has conversions to do: a single conversion is in flight or
+// Timer0A is triggering them, so ADC0 and Timer0 need their clocks;
+// safe to call before Timer0 has been clocked
+int BSP_Accelerometer_Busy(void);
+void ADC0Seq2_Handler(void);
 
 //Light sensor
 void BSP_LightSensor_Init(void);
 uint32_t BSP_LightSensor_Input(void);
 void BSP_LightSensor_Start(void);
 int BSP_LightSensor_End(uint32_t *light);
+// 1 if BSP_LightSensor_End() would return a completed measurement
+int BSP_LightSensor_Ready(void);
+// Interrupt-driven light sensor (call after BSP_LightSensor_Init(); needed
+// by BSP_LightSensor_Start/End). The OPT3001 INT line (PA5) interrupts when
+// the conversion is done, the result is read over I2C in the background, and
+// then task runs from the I2C ISR; BSP_LightSensor_End() just returns it.
+void BSP_LightSensor_InitInterrupt(void(*task)(void), uint32_t priority);
+// Continuous conversion (after BSP_LightSensor_InitInterrupt()). The sensor
+// is configured once; task then runs after every conversion (100 or 800 ms)
+// and BSP_LightSensor_End() returns the newest value. Ignored while a
+// single-shot measurement is in progress. Stopping does not wait: the
+// sensor is shut down in the background, and a start requested before that
+// has finished takes effect as soon as it has.
+#define LIGHT_CONVERSION_100MS 0
+#define LIGHT_CONVERSION_800MS 1
+void BSP_LightSensor_StartContinuous(uint32_t convtime);
+void BSP_LightSensor_StopContinuous(void);
+void GPIOPortA_Handler(void);
+
+#if BENCH_MODE
+// The internal I2C and light sensor helpers, for the benchmark (bench.h).
+uint16_t BSP_Bench_I2C_Send3(void);
+uint16_t BSP_Bench_I2C_Recv2(void);
+int32_t BSP_Bench_LightSensorEnd(void);
+#endif
 
 #endif /* INC_BSP_H_ */
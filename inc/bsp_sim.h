@@ -0,0 +1,188 @@
+// bsp_sim.h
+// Host build of bsp.c (define BSP_HOST_SIM). Every register bsp.c uses is
+// redirected from its address to SimRegister(), which runs a model of the
+// TM4C123 peripherals behind it (tools/bsp_sim.c):
+// ADC0 SS2 with Timer0A triggering, uDMA channel 16 moving SS2 results,
+// I2C1 master with an OPT3001 on the bus, GPIO Port A edge interrupts, and
+// the NVIC for their three IRQs.
+// The handlers in bsp.c are called from the model when their interrupts are
+// enabled and pending.
+//
+// Each access costs SIM_ACCESS_CYCLES of simulated time, so polling loops
+// see the peripherals make progress. The uDMA control table holds 32-bit
+// bus addresses, which cannot hold host pointers, so bsp.c puts pointers
+// there through SimDMAAddress(), and the model maps them back.
+//
+// A register bsp.c starts using needs a line below; without one the host
+// build dereferences the real address and faults.
+
+#ifndef INC_BSP_SIM_H_
+#define INC_BSP_SIM_H_
+
+#include <stdint.h>
+#include "inc/tm4c123gh6pm.h"
+
+#define SIM_CLOCK_HZ       50000000  // bus clock of the model
+#define SIM_ACCESS_CYCLES  2         // simulated cycles per register access
+
+// Returns the register at addr, after bringing the model up to date. The
+// access through the pointer is seen when the next one starts.
+volatile uint32_t *SimRegister(uint32_t addr);
+#define SIM_REG(addr)      (*SimRegister(addr))
+
+// A 32-bit bus address standing for p in the uDMA control table; 0 if the
+// model has run out of them
+uint32_t SimDMAAddress(void *p);
+
+// PRIMASK; interrupts are taken when it is clear and no handler is running
+uint32_t SimDisableInterrupts(void);
+void SimRestoreInterrupts(uint32_t sr);
+
+// Test and benchmark hooks
+void SimReset(void);                 // power-on state, time 0
+void SimRun(uint32_t cycles);        // let time pass without register accesses
+uint64_t SimCycles(void);            // simulated cycles since SimReset()
+void SimSetAnalog(int channel, uint16_t code); // 12-bit ADC input
+void SimSetLight(uint16_t result);   // OPT3001 Result Register, exponent and mantissa
+
+// PA5, the OPT3001 INT pin, as seen through the GPIO data mask
+#define SIM_LIGHTINT       SIM_REG(0x40004080)
+
+#undef ADC0_ACTSS_R
+#define ADC0_ACTSS_R           SIM_REG(0x40038000)
+#undef ADC0_EMUX_R
+#define ADC0_EMUX_R            SIM_REG(0x40038014)
+#undef ADC0_IM_R
+#define ADC0_IM_R              SIM_REG(0x40038008)
+#undef ADC0_ISC_R
+#define ADC0_ISC_R             SIM_REG(0x4003800C)
+#undef ADC0_PC_R
+#define ADC0_PC_R              SIM_REG(0x40038FC4)
+#undef ADC0_PSSI_R
+#define ADC0_PSSI_R            SIM_REG(0x40038028)
+#undef ADC0_RIS_R
+#define ADC0_RIS_R             SIM_REG(0x40038004)
+#undef ADC0_SSCTL2_R
+#define ADC0_SSCTL2_R          SIM_REG(0x40038084)
+#undef ADC0_SSFIFO2_R
+#define ADC0_SSFIFO2_R         SIM_REG(0x40038088)
+#undef ADC0_SSMUX2_R
+#define ADC0_SSMUX2_R          SIM_REG(0x40038080)
+#undef ADC0_SSPRI_R
+#define ADC0_SSPRI_R           SIM_REG(0x40038020)
+#undef GPIO_PORTA_AFSEL_R
+#define GPIO_PORTA_AFSEL_R     SIM_REG(0x40004420)
+#undef GPIO_PORTA_AMSEL_R
+#define GPIO_PORTA_AMSEL_R     SIM_REG(0x40004528)
+#undef GPIO_PORTA_DEN_R
+#define GPIO_PORTA_DEN_R       SIM_REG(0x4000451C)
+#undef GPIO_PORTA_DIR_R
+#define GPIO_PORTA_DIR_R       SIM_REG(0x40004400)
+#undef GPIO_PORTA_IBE_R
+#define GPIO_PORTA_IBE_R       SIM_REG(0x40004408)
+#undef GPIO_PORTA_ICR_R
+#define GPIO_PORTA_ICR_R       SIM_REG(0x4000441C)
+#undef GPIO_PORTA_IEV_R
+#define GPIO_PORTA_IEV_R       SIM_REG(0x4000440C)
+#undef GPIO_PORTA_IM_R
+#define GPIO_PORTA_IM_R        SIM_REG(0x40004410)
+#undef GPIO_PORTA_IS_R
+#define GPIO_PORTA_IS_R        SIM_REG(0x40004404)
+#undef GPIO_PORTA_MIS_R
+#define GPIO_PORTA_MIS_R       SIM_REG(0x40004418)
+#undef GPIO_PORTA_ODR_R
+#define GPIO_PORTA_ODR_R       SIM_REG(0x4000450C)
+#undef GPIO_PORTA_PCTL_R
+#define GPIO_PORTA_PCTL_R      SIM_REG(0x4000452C)
+#undef GPIO_PORTD_AFSEL_R
+#define GPIO_PORTD_AFSEL_R     SIM_REG(0x40007420)
+#undef GPIO_PORTD_AMSEL_R
+#define GPIO_PORTD_AMSEL_R     SIM_REG(0x40007528)
+#undef GPIO_PORTD_DEN_R
+#define GPIO_PORTD_DEN_R       SIM_REG(0x4000751C)
+#undef GPIO_PORTD_DIR_R
+#define GPIO_PORTD_DIR_R       SIM_REG(0x40007400)
+#undef I2C1_MCR_R
+#define I2C1_MCR_R             SIM_REG(0x40021020)
+#undef I2C1_MCS_R
+#define I2C1_MCS_R             SIM_REG(0x40021004)
+#undef I2C1_MDR_R
+#define I2C1_MDR_R             SIM_REG(0x40021008)
+#undef I2C1_MICR_R
+#define I2C1_MICR_R            SIM_REG(0x4002101C)
+#undef I2C1_MIMR_R
+#define I2C1_MIMR_R            SIM_REG(0x40021010)
+#undef I2C1_MRIS_R
+#define I2C1_MRIS_R            SIM_REG(0x40021014)
+#undef I2C1_MSA_R
+#define I2C1_MSA_R             SIM_REG(0x40021000)
+#undef I2C1_MTPR_R
+#define I2C1_MTPR_R            SIM_REG(0x4002100C)
+#undef NVIC_DIS1_R
+#define NVIC_DIS1_R            SIM_REG(0xE000E184)
+#undef NVIC_EN0_R
+#define NVIC_EN0_R             SIM_REG(0xE000E100)
+#undef NVIC_EN1_R
+#define NVIC_EN1_R             SIM_REG(0xE000E104)
+#undef NVIC_PRI0_R
+#define NVIC_PRI0_R            SIM_REG(0xE000E400)
+#undef NVIC_PRI4_R
+#define NVIC_PRI4_R            SIM_REG(0xE000E410)
+#undef NVIC_PRI9_R
+#define NVIC_PRI9_R            SIM_REG(0xE000E424)
+#undef SYSCTL_PRADC_R
+#define SYSCTL_PRADC_R         SIM_REG(0x400FEA38)
+#undef SYSCTL_PRDMA_R
+#define SYSCTL_PRDMA_R         SIM_REG(0x400FEA0C)
+#undef SYSCTL_PRGPIO_R
+#define SYSCTL_PRGPIO_R        SIM_REG(0x400FEA08)
+#undef SYSCTL_PRTIMER_R
+#define SYSCTL_PRTIMER_R       SIM_REG(0x400FEA04)
+#undef SYSCTL_RCC2_R
+#define SYSCTL_RCC2_R          SIM_REG(0x400FE070)
+#undef SYSCTL_RCC_R
+#define SYSCTL_RCC_R           SIM_REG(0x400FE060)
+#undef SYSCTL_RCGCADC_R
+#define SYSCTL_RCGCADC_R       SIM_REG(0x400FE638)
+#undef SYSCTL_RCGCDMA_R
+#define SYSCTL_RCGCDMA_R       SIM_REG(0x400FE60C)
+#undef SYSCTL_RCGCGPIO_R
+#define SYSCTL_RCGCGPIO_R      SIM_REG(0x400FE608)
+#undef SYSCTL_RCGCI2C_R
+#define SYSCTL_RCGCI2C_R       SIM_REG(0x400FE620)
+#undef SYSCTL_RCGCTIMER_R
+#define SYSCTL_RCGCTIMER_R     SIM_REG(0x400FE604)
+#undef SYSCTL_RIS_R
+#define SYSCTL_RIS_R           SIM_REG(0x400FE050)
+#undef TIMER0_CFG_R
+#define TIMER0_CFG_R           SIM_REG(0x40030000)
+#undef TIMER0_CTL_R
+#define TIMER0_CTL_R           SIM_REG(0x4003000C)
+#undef TIMER0_IMR_R
+#define TIMER0_IMR_R           SIM_REG(0x40030018)
+#undef TIMER0_TAILR_R
+#define TIMER0_TAILR_R         SIM_REG(0x40030028)
+#undef TIMER0_TAMR_R
+#define TIMER0_TAMR_R          SIM_REG(0x40030004)
+#undef TIMER0_TAPR_R
+#define TIMER0_TAPR_R          SIM_REG(0x40030038)
+#undef UDMA_ALTCLR_R
+#define UDMA_ALTCLR_R          SIM_REG(0x400FF034)
+#undef UDMA_CFG_R
+#define UDMA_CFG_R             SIM_REG(0x400FF004)
+#undef UDMA_CHIS_R
+#define UDMA_CHIS_R            SIM_REG(0x400FF504)
+#undef UDMA_CHMAP2_R
+#define UDMA_CHMAP2_R          SIM_REG(0x400FF518)
+#undef UDMA_CTLBASE_R
+#define UDMA_CTLBASE_R         SIM_REG(0x400FF008)
+#undef UDMA_ENASET_R
+#define UDMA_ENASET_R          SIM_REG(0x400FF028)
+#undef UDMA_PRIOCLR_R
+#define UDMA_PRIOCLR_R         SIM_REG(0x400FF03C)
+#undef UDMA_REQMASKCLR_R
+#define UDMA_REQMASKCLR_R      SIM_REG(0x400FF024)
+#undef UDMA_USEBURSTCLR_R
+#define UDMA_USEBURSTCLR_R     SIM_REG(0x400FF01C)
+
+#endif /* INC_BSP_SIM_H_ */
@@ -0,0 +1,23 @@
+//*****************************************************************************
+//
+// log_formats.h - The log message table.
+//
+// Each entry is LOG_FORMAT(id, "format"). The including file defines
+// LOG_FORMAT to turn the table into what it needs: log_task.h makes the
+// IDs, log_task.c the strings for on-target formatting, and the host
+// decoder in tools/ the strings for expanding deferred messages.
+//
+// Arguments are sent as raw 32-bit words, so only integer conversions
+// (%c, %d, %i, %u, %x, %X) may be used, with at most LOG_MAX_ARGS of them.
+// Add new entries at the end only, so the IDs in old captures keep their
+// meaning.
+//
+//*****************************************************************************
+LOG_FORMAT(LOG_ACCEL_SAMPLE,  "[x,y,z] = [%d, %d, %d]\n")
+LOG_FORMAT(LOG_LIGHT_SAMPLE,  "light = %d\n")
+LOG_FORMAT(LOG_LEFT_BUTTON,   "Left Button is pressed.\n")
+LOG_FORMAT(LOG_RIGHT_BUTTON,  "Right Button is pressed.\n")
+LOG_FORMAT(LOG_QUEUE_FULL,    "\nQueue full. This should never happen.\n")
+LOG_FORMAT(LOG_CPU_LOAD,      "CPU load = %d%%, log dropped %d records\n")
+LOG_FORMAT(LOG_LEFT_LONG,     "Left Button is held.\n")
+LOG_FORMAT(LOG_RIGHT_LONG,    "Right Button is held.\n")
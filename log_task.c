@@ -0,0 +1,521 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include "utils/ustdlib.h"
+#include "priorities.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "uart_tx.h"
+#include "telemetry.h"
+#include "atomic.h"
+#include "sample_block.h"
+#include "log_task.h"
+
+//*****************************************************************************
+//
+// The stack size for the logger task, and the stack itself. It is
+// allocated statically rather than from the FreeRTOS heap. Framing a sample
+// block puts a whole telemetry record on this stack.
+//
+//*****************************************************************************
+#define LOGTASKSTACKSIZE           160         // Stack size in words
+static portSTACK_TYPE g_pui32LogTaskStack[LOGTASKSTACKSIZE];
+
+//*****************************************************************************
+//
+// The longest time, in ms, the logger sleeps before looking for records a
+// producer did not wake it for.
+//
+//*****************************************************************************
+#define LOG_FLUSH_MS               50
+
+//*****************************************************************************
+//
+// The record queue. This is a bounded queue in which every slot carries a
+// sequence number: a slot is free for the producer that reserves position n
+// when its sequence is n, and full for the consumer when it is n + 1.
+// Producers reserve positions by compare-and-swap on g_ui32LogHead, so any
+// number of tasks can push without a lock; only the logger task pops.
+//
+//*****************************************************************************
+typedef struct
+{
+    volatile uint32_t ui32Sequence;
+    volatile uint8_t ui8Length;
+    volatile bool bBinary;          // send as is, without newline translation
+    volatile char pcText[LOG_RECORD_SIZE];
+}
+tLogRecord;
+
+static tLogRecord g_psLogRecords[LOG_QUEUE_SIZE];
+static volatile uint32_t g_ui32LogHead;
+static uint32_t g_ui32LogTail;
+static volatile uint32_t g_ui32LogDropped;
+
+//*****************************************************************************
+//
+// The sample block queue. It holds only pointers; the logger frames each
+// block from the pool and frees it once it is in the UART ring. Only the
+// Sensor task writes to it, so the head and tail need no atomics.
+//
+//*****************************************************************************
+static tSampleBlock * volatile g_ppsLogBlocks[LOG_BLOCK_QUEUE_SIZE];
+static volatile uint32_t g_ui32LogBlockHead;
+static volatile uint32_t g_ui32LogBlockTail;
+
+//*****************************************************************************
+//
+// Given by a producer that pushed into an empty queue, to wake the logger.
+//
+//*****************************************************************************
+static xSemaphoreHandle g_pLogSemaphore;
+
+//*****************************************************************************
+//
+// A baud rate change asked for by LogSetBaud(), which the logger makes once
+// its queues are empty, or 0 if none; and whether the change worked.
+//
+//*****************************************************************************
+static volatile uint32_t g_ui32LogBaud;
+static volatile bool g_bLogBaudSet;
+
+//*****************************************************************************
+//
+// Queues one record holding up to LOG_RECORD_SIZE bytes of pcBuf. Returns
+// false, and counts the record as dropped, if the queue is full. Never
+// blocks; safe to call from any task, and before the scheduler starts.
+//
+//*****************************************************************************
+static bool
+LogPush(const char *pcBuf, uint32_t ui32Len, bool bBinary)
+{
+    tLogRecord *psRecord;
+    uint32_t ui32Pos, i;
+
+    //
+    // Reserve a position. Another producer may take the same one first, in
+    // which case the swap fails and the next position is tried.
+    //
+    do
+    {
+        ui32Pos = g_ui32LogHead;
+        psRecord = &g_psLogRecords[ui32Pos & (LOG_QUEUE_SIZE - 1)];
+        if(psRecord->ui32Sequence != ui32Pos)
+        {
+            //
+            // The logger has not emptied this slot yet, so the queue is
+            // full, unless another producer has just moved the head on.
+            //
+            if(ui32Pos == g_ui32LogHead)
+            {
+                AtomicAdd(&g_ui32LogDropped, 1);
+                return(false);
+            }
+            continue;
+        }
+    }
+    while(!AtomicCompareAndSwap(&g_ui32LogHead, ui32Pos, ui32Pos + 1));
+
+    //
+    // The slot is ours until its sequence is published.
+    //
+    if(ui32Len > LOG_RECORD_SIZE)
+    {
+        ui32Len = LOG_RECORD_SIZE;
+    }
+    for(i = 0; i < ui32Len; i++)
+    {
+        psRecord->pcText[i] = pcBuf[i];
+    }
+    psRecord->ui8Length = ui32Len;
+    psRecord->bBinary = bBinary;
+    psRecord->ui32Sequence = ui32Pos + 1;
+
+    //
+    // Only the push into an empty queue needs to wake the logger; it keeps
+    // draining until the queue is empty again.
+    //
+    if((ui32Pos == g_ui32LogTail) && (g_pLogSemaphore != NULL))
+    {
+        xSemaphoreGive(g_pLogSemaphore);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Queues text; newlines go out as CR/LF.
+//
+//*****************************************************************************
+bool
+LogWrite(const char *pcBuf, uint32_t ui32Len)
+{
+    return(LogPush(pcBuf, ui32Len, false));
+}
+
+//*****************************************************************************
+//
+// Queues binary data, such as a telemetry frame, to be sent unchanged.
+//
+//*****************************************************************************
+bool
+LogWriteBinary(const uint8_t *pui8Buf, uint32_t ui32Len)
+{
+    return(LogPush((const char *)pui8Buf, ui32Len, true));
+}
+
+//*****************************************************************************
+//
+// Queues a filled sample block to be sent as one telemetry record. The
+// logger owns the block from here on and frees it once sent; if the queue is
+// full it is freed now and counted as dropped. Only the Sensor task may call
+// this.
+//
+//*****************************************************************************
+bool
+LogWriteBlock(tSampleBlock *psBlock)
+{
+    uint32_t ui32Head = g_ui32LogBlockHead;
+
+    if((ui32Head - g_ui32LogBlockTail) == LOG_BLOCK_QUEUE_SIZE)
+    {
+        SampleBlockFree(psBlock);
+        AtomicAdd(&g_ui32LogDropped, 1);
+        return(false);
+    }
+    g_ppsLogBlocks[ui32Head & (LOG_BLOCK_QUEUE_SIZE - 1)] = psBlock;
+    g_ui32LogBlockHead = ui32Head + 1;
+
+    if((ui32Head == g_ui32LogBlockTail) && (g_pLogSemaphore != NULL))
+    {
+        xSemaphoreGive(g_pLogSemaphore);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Formats one record, like UARTprintf(), and queues it with LogWrite().
+//
+//*****************************************************************************
+bool
+LogPrintf(const char *pcString, ...)
+{
+    char pcText[LOG_RECORD_SIZE + 1];
+    va_list vaArgP;
+    int iLen;
+
+    va_start(vaArgP, pcString);
+    iLen = uvsnprintf(pcText, sizeof(pcText), pcString, vaArgP);
+    va_end(vaArgP);
+
+    return(LogWrite(pcText, (iLen > LOG_RECORD_SIZE) ? LOG_RECORD_SIZE : iLen));
+}
+
+//*****************************************************************************
+//
+// The format strings, for building without LOG_DEFERRED.
+//
+//*****************************************************************************
+#if !LOG_DEFERRED
+#define LOG_FORMAT(id, format)     format,
+static const char * const g_ppcLogFormats[NUM_LOG_FORMATS] =
+{
+#include "log_formats.h"
+};
+#undef LOG_FORMAT
+#endif
+
+//*****************************************************************************
+//
+// Encodes one message from log_formats.h into pcBuf, which holds ui32Size
+// bytes, in the form it goes out on the wire: a telemetry log record with
+// LOG_DEFERRED, text otherwise. Returns the encoded length, or 0 if it does
+// not fit. Callers may pack several messages into one log record this way
+// and send them with LogWriteEncoded().
+//
+//*****************************************************************************
+uint32_t
+LogEncode(char *pcBuf, uint32_t ui32Size, uint32_t ui32Format,
+          const uint32_t *pui32Args, uint32_t ui32Count)
+{
+#if LOG_DEFERRED
+    return(TelemetryLogFrame((uint8_t *)pcBuf, ui32Size, ui32Format,
+                             pui32Args, ui32Count));
+#else
+    uint32_t pui32Words[LOG_MAX_ARGS] = { 0 }, i;
+    int iLen;
+
+    //
+    // usnprintf() is passed every argument word, whatever the format uses,
+    // but the caller only has ui32Count of them; the rest are zero.
+    //
+    for(i = 0; (i < ui32Count) && (i < LOG_MAX_ARGS); i++)
+    {
+        pui32Words[i] = pui32Args[i];
+    }
+    iLen = usnprintf(pcBuf, ui32Size, g_ppcLogFormats[ui32Format],
+                     pui32Words[0], pui32Words[1], pui32Words[2],
+                     pui32Words[3]);
+    return(((uint32_t)iLen < ui32Size) ? iLen : 0);
+#endif
+}
+
+//*****************************************************************************
+//
+// Queues messages built with LogEncode().
+//
+//*****************************************************************************
+bool
+LogWriteEncoded(const char *pcBuf, uint32_t ui32Len)
+{
+    return(LogPush(pcBuf, ui32Len, LOG_DEFERRED));
+}
+
+//*****************************************************************************
+//
+// Logs one message from log_formats.h; use the LOG0() to LOG4() macros,
+// which fill in ui32Count.
+//
+//*****************************************************************************
+bool
+LogMessage(uint32_t ui32Format, uint32_t ui32Count, ...)
+{
+    char pcRecord[LOG_RECORD_SIZE];
+    uint32_t pui32Args[LOG_MAX_ARGS] = { 0 };
+    uint32_t ui32Len, i;
+    va_list vaArgP;
+
+    va_start(vaArgP, ui32Count);
+    for(i = 0; (i < ui32Count) && (i < LOG_MAX_ARGS); i++)
+    {
+        pui32Args[i] = va_arg(vaArgP, uint32_t);
+    }
+    va_end(vaArgP);
+
+    ui32Len = LogEncode(pcRecord, sizeof(pcRecord), ui32Format, pui32Args, i);
+    return((ui32Len != 0) && LogWriteEncoded(pcRecord, ui32Len));
+}
+
+//*****************************************************************************
+//
+// Returns the number of free records in the queue. Only a hint when there
+// are several producers.
+//
+//*****************************************************************************
+uint32_t
+LogFree(void)
+{
+    return(LOG_QUEUE_SIZE - (g_ui32LogHead - g_ui32LogTail));
+}
+
+//*****************************************************************************
+//
+// Returns the number of free slots in the sample block queue.
+//
+//*****************************************************************************
+uint32_t
+LogBlockFree(void)
+{
+    return(LOG_BLOCK_QUEUE_SIZE - (g_ui32LogBlockHead - g_ui32LogBlockTail));
+}
+
+//*****************************************************************************
+//
+// Returns the number of records and blocks dropped because a queue was full.
+//
+//*****************************************************************************
+uint32_t
+LogDropped(void)
+{
+    return(g_ui32LogDropped);
+}
+
+//*****************************************************************************
+//
+// Counts a message its producer gave up on before it reached the queue, in
+// the total LogDropped() returns.
+//
+//*****************************************************************************
+void
+LogDrop(void)
+{
+    AtomicAdd(&g_ui32LogDropped, 1);
+}
+
+//*****************************************************************************
+//
+// Has the logger set UART0 to ui32Baud and waits until it has. The logger
+// owns UART0, so it makes the change itself, between records, once
+// everything queued before has gone out at the old rate. Returns false if
+// the rate cannot be made. Call from a task other than the logger.
+//
+//*****************************************************************************
+bool
+LogSetBaud(uint32_t ui32Baud)
+{
+    if(ui32Baud == 0)
+    {
+        return(false);
+    }
+    g_ui32LogBaud = ui32Baud;
+    xSemaphoreGive(g_pLogSemaphore);
+    while(g_ui32LogBaud != 0)
+    {
+        vTaskDelay(1);
+    }
+    return(g_bLogBaudSet);
+}
+
+//*****************************************************************************
+//
+// Frames the oldest sample block into the UART transmit ring and frees it.
+// Returns false if there is none. Framing is the only pass over the
+// samples between the driver and the wire.
+//
+//*****************************************************************************
+static bool
+LogSendBlock(void)
+{
+    static uint8_t pui8Frame[TELEMETRY_FRAME_SIZE(SAMPLE_BLOCK_DATA_SIZE)];
+    tSampleBlock *psBlock;
+    uint32_t ui32Len;
+
+    if(g_ui32LogBlockTail == g_ui32LogBlockHead)
+    {
+        return(false);
+    }
+    psBlock = g_ppsLogBlocks[g_ui32LogBlockTail & (LOG_BLOCK_QUEUE_SIZE - 1)];
+    g_ui32LogBlockTail++;
+
+    ui32Len = TelemetryFrame(pui8Frame, sizeof(pui8Frame), psBlock->ui8Type,
+                             psBlock->ui8Sequence, psBlock->ui32Time,
+                             psBlock->ui32PeriodMs, psBlock->pui32Data,
+                             psBlock->ui8Count, psBlock->ui8SampleSize);
+    SampleBlockFree(psBlock);
+
+    while(UARTTxSpace() < ui32Len)
+    {
+        vTaskDelay(1);
+    }
+    UARTTxWriteBinary(pui8Frame, ui32Len);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// This task owns UART0. It moves each record and sample block into the UART
+// transmit ring, waiting for room rather than dropping, so the only place
+// output is lost is the queues. Records and blocks take turns.
+//
+//*****************************************************************************
+static void
+LogTask(void *pvParameters)
+{
+    tLogRecord *psRecord;
+    char pcText[LOG_RECORD_SIZE];
+    uint32_t ui32Len, i;
+    bool bBinary, bBlock;
+
+    while(1)
+    {
+        bBlock = LogSendBlock();
+
+        psRecord = &g_psLogRecords[g_ui32LogTail & (LOG_QUEUE_SIZE - 1)];
+        if(psRecord->ui32Sequence != (g_ui32LogTail + 1))
+        {
+            //
+            // Empty. Once the blocks are out too, a baud rate change asked
+            // for by LogSetBaud() cannot cut anything short. Otherwise sleep
+            // until a producer pushes.
+            //
+            if(bBlock)
+            {
+                continue;
+            }
+            if(g_ui32LogBaud != 0)
+            {
+                g_bLogBaudSet = UARTTxSetBaud(g_ui32LogBaud);
+                g_ui32LogBaud = 0;
+            }
+            else
+            {
+                xSemaphoreTake(g_pLogSemaphore,
+                               LOG_FLUSH_MS / portTICK_RATE_MS);
+            }
+            continue;
+        }
+
+        ui32Len = psRecord->ui8Length;
+        bBinary = psRecord->bBinary;
+        for(i = 0; i < ui32Len; i++)
+        {
+            pcText[i] = psRecord->pcText[i];
+        }
+
+        //
+        // Hand the slot back to the producers.
+        //
+        psRecord->ui32Sequence = g_ui32LogTail + LOG_QUEUE_SIZE;
+        g_ui32LogTail++;
+
+        //
+        // Every newline may turn into two bytes on the wire.
+        //
+        while(UARTTxSpace() < (2 * ui32Len))
+        {
+            vTaskDelay(1);
+        }
+        if(bBinary)
+        {
+            UARTTxWriteBinary((const uint8_t *)pcText, ui32Len);
+        }
+        else
+        {
+            UARTTxWrite(pcText, ui32Len);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Initializes the record queue and creates the logger task. Call before
+// the first LogWrite().
+//
+//*****************************************************************************
+uint32_t
+LogTaskInit(void)
+{
+    uint32_t i;
+
+    for(i = 0; i < LOG_QUEUE_SIZE; i++)
+    {
+        g_psLogRecords[i].ui32Sequence = i;
+    }
+    g_ui32LogHead = 0;
+    g_ui32LogTail = 0;
+    g_ui32LogBlockHead = 0;
+    g_ui32LogBlockTail = 0;
+
+    vSemaphoreCreateBinary(g_pLogSemaphore);
+    if(g_pLogSemaphore == NULL)
+    {
+        return(1);
+    }
+    xSemaphoreTake(g_pLogSemaphore, 0);
+
+    if(xTaskGenericCreate(LogTask, (const signed char *)"Log",
+                          LOGTASKSTACKSIZE, NULL,
+                          tskIDLE_PRIORITY + PRIORITY_LOG_TASK, NULL,
+                          g_pui32LogTaskStack, NULL) != pdTRUE)
+    {
+        return(1);
+    }
+
+    return(0);
+}
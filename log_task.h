@@ -0,0 +1,78 @@
+#ifndef __LOG_TASK_H__
+#define __LOG_TASK_H__
+
+#include "sample_block.h"
+
+//*****************************************************************************
+//
+// Log records. Producers copy their text into a fixed-size record in a
+// lock-free queue and return at once; the logger task is the only writer to
+// UART0. A record that does not fit is dropped and counted, so producers
+// never block on the log.
+//
+//*****************************************************************************
+
+// Text bytes in one record; longer output is truncated.
+#define LOG_RECORD_SIZE            64
+
+// Records in the queue; must be a power of two.
+#define LOG_QUEUE_SIZE             16
+
+// Sample blocks waiting to be sent; must be a power of two. A block goes
+// out as one telemetry record, straight from the pool block that holds it.
+#define LOG_BLOCK_QUEUE_SIZE       8
+
+//*****************************************************************************
+//
+// Messages from the table in log_formats.h, logged with LOG0() to LOG4().
+// With LOG_DEFERRED set, the target never formats them: each one is sent
+// as its format ID and raw argument words in a telemetry record (see
+// telemetry.h), and tools/telemetry_decode expands it from the same table.
+// Otherwise they are formatted on the target like LogPrintf().
+//
+// It is clear by default, so the port still reads as text on a plain
+// terminal. Define LOG_DEFERRED=1 in the build options to turn it on, and
+// read the port through tools/telemetry_decode.
+//
+//*****************************************************************************
+#ifndef LOG_DEFERRED
+#define LOG_DEFERRED               0
+#endif
+
+#define LOG_MAX_ARGS               4
+
+#define LOG_FORMAT(id, format)     id,
+enum
+{
+#include "log_formats.h"
+    NUM_LOG_FORMATS
+};
+#undef LOG_FORMAT
+
+#define LOG0(id)                   LogMessage(id, 0)
+#define LOG1(id, a)                LogMessage(id, 1, (uint32_t)(a))
+#define LOG2(id, a, b)             LogMessage(id, 2, (uint32_t)(a),         \
+                                              (uint32_t)(b))
+#define LOG3(id, a, b, c)          LogMessage(id, 3, (uint32_t)(a),         \
+                                              (uint32_t)(b), (uint32_t)(c))
+#define LOG4(id, a, b, c, d)       LogMessage(id, 4, (uint32_t)(a),         \
+                                              (uint32_t)(b), (uint32_t)(c), \
+                                              (uint32_t)(d))
+
+// Prototypes for the logger.
+extern uint32_t LogTaskInit(void);
+extern bool LogWrite(const char *pcBuf, uint32_t ui32Len);
+extern bool LogWriteBinary(const uint8_t *pui8Buf, uint32_t ui32Len);
+extern bool LogWriteBlock(tSampleBlock *psBlock);
+extern bool LogPrintf(const char *pcString, ...);
+extern bool LogMessage(uint32_t ui32Format, uint32_t ui32Count, ...);
+extern uint32_t LogEncode(char *pcBuf, uint32_t ui32Size, uint32_t ui32Format,
+                          const uint32_t *pui32Args, uint32_t ui32Count);
+extern bool LogWriteEncoded(const char *pcBuf, uint32_t ui32Len);
+extern uint32_t LogFree(void);
+extern uint32_t LogBlockFree(void);
+extern uint32_t LogDropped(void);
+extern void LogDrop(void);
+extern bool LogSetBaud(uint32_t ui32Baud);
+
+#endif // __LOG_TASK_H__
@@ -3,6 +3,7 @@
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "inc/hw_ints.h"
+#include "inc/hw_nvic.h"
 #include "driverlib/fpu.h"
 #include "driverlib/gpio.h"
 #include "driverlib/pin_map.h"
@@ -15,7 +16,13 @@
 #include "queue.h"
 #include "semphr.h"
 #include "sensor_task.h"
-#include "switch_sensor_task.h"
+#include "switches.h"
+#include "inc/bsp.h"
+#include "uart_tx.h"
+#include "log_task.h"
+#include "pool.h"
+#include "power.h"
+#include "bench.h"
 
 //*****************************************************************************
 //
@@ -32,19 +39,20 @@
 //! This application utilizes FreeRTOS to perform the tasks in a concurrent
 //! fashion.  The following tasks are created:
 //!
-//! - An LED task, which blinks the user-selected on-board LED at a
-//!   user-selected rate (changed via the buttons).
+//! - A Sensor task, which samples the sensors and acts on the buttons and
+//!   on commands typed on the UART.
 //!
-//! - A Switch task, which monitors the buttons pressed and passes the
-//!   information to LED task.
+//! The buttons are not polled. Their edges interrupt, a timer debounces
+//! them, and press, release and long-press events go straight to the
+//! Sensor task's queue.
 //!
 //! In addition to the tasks, this application also uses the following FreeRTOS
 //! resources:
 //!
 //! - A Queue to enable information transfer between tasks.
 //!
-//! - A Semaphore to guard the resource, UART, from access by multiple tasks at
-//!   the same time.
+//! - A logger task that owns the UART. Other tasks hand it log records
+//!   through a lock-free queue instead of sharing the UART under a mutex.
 //!
 //! - A non-blocking FreeRTOS Delay to put the tasks in blocked state when they
 //!   have nothing to do.
@@ -55,13 +63,6 @@
 //*****************************************************************************
 
 
-//*****************************************************************************
-//
-// The mutex that protects concurrent access of UART from multiple tasks.
-//
-//*****************************************************************************
-xSemaphoreHandle g_pUARTSemaphore;
-
 //*****************************************************************************
 //
 // The error routine that is called if the driver library encounters an error.
@@ -95,7 +96,93 @@ vApplicationStackOverflowHook(xTaskHandle *pxTask, char *pcTaskName)
 
 //*****************************************************************************
 //
-// Configure the UART and its pins.  This must be called before UARTprintf().
+// CPU load measurement. The idle task calls the idle hook in a tight loop
+// whenever no other task is ready, so a short gap between two consecutive
+// calls is idle time; a long gap means something preempted the idle task.
+// Time is taken from the tick count and the SysTick down-counter.
+//
+// The hook sleeps until the next interrupt each time round, and the time
+// asleep is idle time too. It is measured separately, so the gap is taken
+// from the end of the previous call.
+//
+//*****************************************************************************
+#define IDLE_GAP_CYCLES         500
+static volatile uint64_t g_ui64IdleCycles;
+static portTickType g_xLoadStart;
+
+void
+vApplicationIdleHook(void)
+{
+    static portTickType xLastTick;
+    static uint32_t ui32LastCount;
+    portTickType xTick;
+    uint32_t ui32Count, ui32Elapsed, ui32Idle;
+
+    xTick = xTaskGetTickCount();
+    ui32Count = HWREG(NVIC_ST_CURRENT);
+
+    //
+    // A tick between the two reads makes the result wrap to a huge value,
+    // which the gap check discards.
+    //
+    ui32Elapsed = ((xTick - xLastTick) * CYCLES_PER_TICK) + ui32LastCount -
+                  ui32Count;
+    ui32Idle = (ui32Elapsed < IDLE_GAP_CYCLES) ? ui32Elapsed : 0;
+
+    ui32Idle += PowerSleep();
+
+    //
+    // The 64-bit add takes two stores; CPULoadGet() must not run between
+    // them.
+    //
+    taskENTER_CRITICAL();
+    g_ui64IdleCycles += ui32Idle;
+    taskEXIT_CRITICAL();
+
+    xLastTick = xTaskGetTickCount();
+    ui32LastCount = HWREG(NVIC_ST_CURRENT);
+}
+
+//*****************************************************************************
+//
+// Returns the percentage of time the CPU was busy since the previous call.
+// The cycle counts are 64-bit (see power.h), as calls may be more than 86 s
+// apart.
+//
+//*****************************************************************************
+uint32_t
+CPULoadGet(void)
+{
+    portTickType xNow;
+    uint64_t ui64Total, ui64Idle;
+
+    taskENTER_CRITICAL();
+    xNow = xTaskGetTickCount();
+    ui64Idle = g_ui64IdleCycles;
+    g_ui64IdleCycles = 0;
+    taskEXIT_CRITICAL();
+    ui64Total = (uint64_t)(xNow - g_xLoadStart) * CYCLES_PER_TICK;
+    g_xLoadStart = xNow;
+
+    if(ui64Total == 0)
+    {
+        return(0);
+    }
+    return(100 - PowerPercent(ui64Idle, ui64Total));
+}
+
+//*****************************************************************************
+//
+// The console baud rate. UART0 runs from the system clock, so rates up to
+// 1.5 Mbaud and beyond work; see UARTTxSetBaud().
+//
+//*****************************************************************************
+#define UART_BAUD_RATE          115200
+
+//*****************************************************************************
+//
+// Configure the UART and its pins.  This must be called before the logger
+// task writes to it.
 //
 //*****************************************************************************
 void
@@ -127,6 +214,18 @@ ConfigureUART(void)
     // Initialize the UART for console I/O.
     //
     UARTStdioConfig(0, 115200, 16000000);
+
+    //
+    // Send all output through the interrupt-driven ring so printing never
+    // waits for the line.
+    //
+    UARTTxInit();
+
+    //
+    // Move to the system clock, which reaches far higher rates than the
+    // PIOSC. If the rate cannot be made, stay at 115,200 from the PIOSC.
+    //
+    UARTTxSetBaud(UART_BAUD_RATE);
 }
 
 //*****************************************************************************
@@ -143,33 +242,55 @@ main(void)
     ROM_SysCtlClockSet(SYSCTL_SYSDIV_4 | SYSCTL_USE_PLL | SYSCTL_XTAL_16MHZ |
                        SYSCTL_OSC_MAIN);
 
+    //
+    // Tell the BSP so its timer periods match the real bus clock.
+    //
+    BSP_Clock_SetFrequency(ROM_SysCtlClockGet());
+
     //
     // Initialize the UART and configure it for 115,200, 8-N-1 operation.
     //
     ConfigureUART();
 
+#if BENCH_MODE
     //
-    // Print demo introduction.
+    // Time the BSP functions while nothing else is running.
     //
-    UARTprintf("\n\nSensor Demo\n");
+    BenchRun();
+#endif
 
     //
-    // Create a mutex to guard the UART.
+    // Fill the sample block pool before any driver can ask for a block.
     //
-    g_pUARTSemaphore = xSemaphoreCreateMutex();
+    PoolInit();
 
-    // Create the switch task
-    if(SensorTaskInit() != 0)
+    //
+    // Let idle peripherals lose their clocks while the core sleeps.
+    //
+    PowerInit();
+
+    //
+    // Create the logger task, which owns the UART from now on.
+    //
+    if(LogTaskInit() != 0)
     {
         while(1) { }
     }
 
+    //
+    // Print demo introduction.
+    //
+    LogPrintf("\n\nSensor Demo\n");
+
     // Create the sensor task.
-    if(SwitchSensorTaskInit() != 0)
+    if(SensorTaskInit() != 0)
     {
         while(1) { }
     }
 
+    // Send button events to its queue.
+    SwitchesInit();
+
     //
     // Start the scheduler.  This should not return.
     //
@@ -0,0 +1,157 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "atomic.h"
+#include "pool.h"
+
+//*****************************************************************************
+//
+// The blocks, word aligned so they can hold any sample type.
+//
+//*****************************************************************************
+static uint32_t g_pui32PoolBlocks[POOL_BLOCK_COUNT][POOL_BLOCK_SIZE / 4];
+
+//*****************************************************************************
+//
+// The free list. It is a stack of block indices linked through
+// g_pui16PoolNext, kept apart from the blocks so a block's owner can never
+// corrupt it. The head word holds the index of the top block in its low 16
+// bits and a count of changes in its high 16; the count makes a head that
+// was popped and pushed back by an interrupt compare unequal, so a pop that
+// read the old next link cannot succeed.
+//
+//*****************************************************************************
+#define POOL_NONE                  0xFFFF
+#define POOL_INDEX(x)              ((x) & 0xFFFF)
+#define POOL_HEAD(ui32Old, ui32Index)                                         \
+    ((((ui32Old) + 0x10000) & 0xFFFF0000) | (ui32Index))
+
+static volatile uint16_t g_pui16PoolNext[POOL_BLOCK_COUNT];
+static volatile uint32_t g_ui32PoolHead;
+
+//*****************************************************************************
+//
+// Statistics: blocks now in use, the most ever in use at once, and
+// allocations refused because the pool was empty.
+//
+//*****************************************************************************
+static volatile uint32_t g_ui32PoolInUse;
+static volatile uint32_t g_ui32PoolHighWater;
+static volatile uint32_t g_ui32PoolFailed;
+
+//*****************************************************************************
+//
+// Puts every block on the free list and clears the statistics.
+//
+//*****************************************************************************
+void
+PoolInit(void)
+{
+    uint32_t i;
+
+    for(i = 0; i < POOL_BLOCK_COUNT; i++)
+    {
+        g_pui16PoolNext[i] = (i + 1 < POOL_BLOCK_COUNT) ? (i + 1) : POOL_NONE;
+    }
+    g_ui32PoolHead = 0;
+    g_ui32PoolInUse = 0;
+    g_ui32PoolHighWater = 0;
+    g_ui32PoolFailed = 0;
+}
+
+//*****************************************************************************
+//
+// Takes a block. Returns 0, and counts the failure, if none is free.
+//
+//*****************************************************************************
+void *
+PoolAlloc(void)
+{
+    uint32_t ui32Old, ui32Index, ui32InUse, ui32High;
+
+    do
+    {
+        ui32Old = g_ui32PoolHead;
+        ui32Index = POOL_INDEX(ui32Old);
+        if(ui32Index == POOL_NONE)
+        {
+            AtomicAdd(&g_ui32PoolFailed, 1);
+            return(0);
+        }
+    }
+    while(!AtomicCompareAndSwap(&g_ui32PoolHead, ui32Old,
+                                POOL_HEAD(ui32Old,
+                                          g_pui16PoolNext[ui32Index])));
+
+    ui32InUse = AtomicAdd(&g_ui32PoolInUse, 1);
+    do
+    {
+        ui32High = g_ui32PoolHighWater;
+    }
+    while((ui32InUse > ui32High) &&
+          !AtomicCompareAndSwap(&g_ui32PoolHighWater, ui32High, ui32InUse));
+
+    return(g_pui32PoolBlocks[ui32Index]);
+}
+
+//*****************************************************************************
+//
+// Gives back a block from PoolAlloc(). Anything else, including 0, is
+// ignored.
+//
+//*****************************************************************************
+void
+PoolFree(void *pvBlock)
+{
+    uint32_t ui32Old, ui32Index, ui32Offset;
+
+    ui32Offset = (uint32_t)((uint8_t *)pvBlock -
+                            (uint8_t *)g_pui32PoolBlocks);
+    ui32Index = ui32Offset / POOL_BLOCK_SIZE;
+    if((pvBlock == 0) || (ui32Index >= POOL_BLOCK_COUNT) ||
+       ((ui32Offset % POOL_BLOCK_SIZE) != 0))
+    {
+        return;
+    }
+
+    AtomicAdd(&g_ui32PoolInUse, -1);
+    do
+    {
+        ui32Old = g_ui32PoolHead;
+        g_pui16PoolNext[ui32Index] = POOL_INDEX(ui32Old);
+    }
+    while(!AtomicCompareAndSwap(&g_ui32PoolHead, ui32Old,
+                                POOL_HEAD(ui32Old, ui32Index)));
+}
+
+//*****************************************************************************
+//
+// Returns the number of blocks in use now.
+//
+//*****************************************************************************
+uint32_t
+PoolInUse(void)
+{
+    return(g_ui32PoolInUse);
+}
+
+//*****************************************************************************
+//
+// Returns the most blocks ever in use at once.
+//
+//*****************************************************************************
+uint32_t
+PoolHighWater(void)
+{
+    return(g_ui32PoolHighWater);
+}
+
+//*****************************************************************************
+//
+// Returns the number of allocations refused because the pool was empty.
+//
+//*****************************************************************************
+uint32_t
+PoolFailed(void)
+{
+    return(g_ui32PoolFailed);
+}
@@ -0,0 +1,23 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+//*****************************************************************************
+//
+// A pool of fixed-size blocks for sample data. Blocks are taken and given
+// back in constant time, without locks, from tasks and interrupt handlers
+// alike. The size and number of blocks are fixed at compile time.
+//
+//*****************************************************************************
+#define POOL_BLOCK_SIZE            128         // bytes, a multiple of 4
+#define POOL_BLOCK_COUNT           16          // at most 65535
+
+// Prototypes for the block pool. PoolInit() must be called before the
+// first PoolAlloc().
+extern void PoolInit(void);
+extern void *PoolAlloc(void);
+extern void PoolFree(void *pvBlock);
+extern uint32_t PoolInUse(void);
+extern uint32_t PoolHighWater(void);
+extern uint32_t PoolFailed(void);
+
+#endif // __POOL_H__
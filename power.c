@@ -0,0 +1,217 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "utils/ustdlib.h"
+#include "inc/bsp.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "log_task.h"
+#include "uart_tx.h"
+#include "power.h"
+
+//*****************************************************************************
+//
+// Peripherals whose clocks are gated in sleep whenever they are idle. Each
+// is asked, with interrupts masked, whether it has work in progress just
+// before the core sleeps; if not, its clock stops until the core wakes.
+//
+//*****************************************************************************
+typedef struct
+{
+    const char *pcName;
+    uint32_t ui32Peripheral;
+    bool (*pfnBusy)(void);
+}
+tPowerGate;
+
+static bool PowerAccelBusy(void)
+{
+    return(BSP_Accelerometer_Busy() != 0);
+}
+
+static bool PowerI2CBusy(void)
+{
+    return(BSP_I2C_Busy() != 0);
+}
+
+// The receiver needs its clock to see a start bit, so UART0 is only gated
+// while the console is off.
+static bool PowerUARTBusy(void)
+{
+    return(UARTTxBusy() || UARTRxEnabled());
+}
+
+static const tPowerGate g_psPowerGates[] =
+{
+    { "ADC",  SYSCTL_PERIPH_ADC0,   PowerAccelBusy },
+    { 0,      SYSCTL_PERIPH_TIMER0, PowerAccelBusy },
+    { "I2C",  SYSCTL_PERIPH_I2C1,   PowerI2CBusy },
+    { "UART", SYSCTL_PERIPH_UART0,  PowerUARTBusy },
+};
+
+#define NUM_POWER_GATES (sizeof(g_psPowerGates) / sizeof(g_psPowerGates[0]))
+
+//*****************************************************************************
+//
+// Sleep residency since the last report: cycles asleep in total, and cycles
+// asleep with each gated clock off.
+//
+//*****************************************************************************
+static volatile uint64_t g_ui64PowerSleepCycles;
+static volatile uint64_t g_pui64PowerGatedCycles[NUM_POWER_GATES];
+static portTickType g_xPowerStart;
+
+//*****************************************************************************
+//
+// Turns on sleep-mode clock gating. The peripherals that can wake the core
+// or that run unattended keep their clocks in sleep: Port A (the light
+// sensor's interrupt and the I2C and UART pins), Port F and Timer 1 (the
+// buttons and their debounce), the uDMA, and the run-time stats timer.
+//
+//*****************************************************************************
+void
+PowerInit(void)
+{
+    uint32_t i;
+
+    ROM_SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_GPIOA);
+    ROM_SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_GPIOF);
+    ROM_SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_TIMER1);
+    ROM_SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_UDMA);
+    ROM_SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_WTIMER0);
+    for(i = 0; i < NUM_POWER_GATES; i++)
+    {
+        ROM_SysCtlPeripheralSleepEnable(g_psPowerGates[i].ui32Peripheral);
+    }
+    ROM_SysCtlPeripheralClockGating(true);
+}
+
+//*****************************************************************************
+//
+// Sleeps until the next interrupt, gating the clocks of the idle
+// peripherals, and returns the number of cycles slept. Called from the idle
+// hook. Interrupts are masked from the busy checks until after waking, so
+// nothing can start work on a gated peripheral in between; a pending
+// interrupt still ends the sleep, and is taken on the way out.
+//
+//*****************************************************************************
+uint32_t
+PowerSleep(void)
+{
+    uint32_t ui32Start, ui32End, ui32Slept, ui32Gated = 0, i;
+
+    ROM_IntMasterDisable();
+
+    for(i = 0; i < NUM_POWER_GATES; i++)
+    {
+        if(g_psPowerGates[i].pfnBusy())
+        {
+            ROM_SysCtlPeripheralSleepEnable(g_psPowerGates[i].ui32Peripheral);
+        }
+        else
+        {
+            ROM_SysCtlPeripheralSleepDisable(g_psPowerGates[i].ui32Peripheral);
+            ui32Gated |= 1 << i;
+        }
+    }
+
+    ui32Start = HWREG(NVIC_ST_CURRENT);
+    ROM_SysCtlSleep();
+    ui32End = HWREG(NVIC_ST_CURRENT);
+
+    //
+    // The tick interrupt wakes the core, so the sleep is shorter than one
+    // SysTick period even if the counter reloaded in between.
+    //
+    ui32Slept = (ui32End <= ui32Start) ? (ui32Start - ui32End) :
+                (ui32Start + CYCLES_PER_TICK - ui32End);
+
+    //
+    // Count it while still masked, so PowerReport() never sees half of a
+    // 64-bit add.
+    //
+    g_ui64PowerSleepCycles += ui32Slept;
+    for(i = 0; i < NUM_POWER_GATES; i++)
+    {
+        if(ui32Gated & (1 << i))
+        {
+            g_pui64PowerGatedCycles[i] += ui32Slept;
+        }
+    }
+
+    ROM_IntMasterEnable();
+
+    return(ui32Slept);
+}
+
+//*****************************************************************************
+//
+// Returns ui64Part as a percentage of ui64Whole, at most 100, or 0 if
+// ui64Whole is 0.
+//
+//*****************************************************************************
+uint32_t
+PowerPercent(uint64_t ui64Part, uint64_t ui64Whole)
+{
+    if(ui64Whole == 0)
+    {
+        return(0);
+    }
+    if(ui64Part > ui64Whole)
+    {
+        ui64Part = ui64Whole;
+    }
+    return((uint32_t)((ui64Part * 100) / ui64Whole));
+}
+
+//*****************************************************************************
+//
+// Logs the share of the time since the previous report the core spent
+// asleep, and for how much of its sleep each gated clock was off.
+//
+//*****************************************************************************
+void
+PowerReport(void)
+{
+    char pcLine[LOG_RECORD_SIZE];
+    uint64_t ui64Total, ui64Slept, pui64Gated[NUM_POWER_GATES];
+    portTickType xNow;
+    uint32_t ui32Used, i;
+
+    //
+    // PowerSleep() adds to the counters with interrupts masked; take them
+    // the same way.
+    //
+    taskENTER_CRITICAL();
+    xNow = xTaskGetTickCount();
+    ui64Slept = g_ui64PowerSleepCycles;
+    g_ui64PowerSleepCycles = 0;
+    for(i = 0; i < NUM_POWER_GATES; i++)
+    {
+        pui64Gated[i] = g_pui64PowerGatedCycles[i];
+        g_pui64PowerGatedCycles[i] = 0;
+    }
+    taskEXIT_CRITICAL();
+    ui64Total = (uint64_t)(xNow - g_xPowerStart) * CYCLES_PER_TICK;
+    g_xPowerStart = xNow;
+    if(ui64Total == 0)
+    {
+        return;
+    }
+
+    ui32Used = usnprintf(pcLine, sizeof(pcLine), "asleep %d%%, off",
+                         PowerPercent(ui64Slept, ui64Total));
+    for(i = 0; i < NUM_POWER_GATES; i++)
+    {
+        if((g_psPowerGates[i].pcName != 0) && (ui32Used < sizeof(pcLine)))
+        {
+            ui32Used += usnprintf(pcLine + ui32Used, sizeof(pcLine) - ui32Used,
+                                  " %s %d%%", g_psPowerGates[i].pcName,
+                                  PowerPercent(pui64Gated[i], ui64Slept));
+        }
+    }
+    LogPrintf("%s\n", pcLine);
+}
@@ -0,0 +1,28 @@
+#ifndef __POWER_H__
+#define __POWER_H__
+
+//*****************************************************************************
+//
+// Sleeping while idle. The idle hook puts the core into sleep mode until the
+// next interrupt, which at the latest is the next tick. With sleep-mode
+// clock gating on, only the peripherals that have work to do keep their
+// clocks while the core sleeps; the rest are gated until it wakes.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// SysTick counts down once per CPU cycle and reloads every tick. Needs
+// FreeRTOS.h. Cycle counts over more than one tick are kept in 64 bits,
+// since at 50 MHz 32 bits wrap after 86 s.
+//
+//*****************************************************************************
+#define CYCLES_PER_TICK         (configCPU_CLOCK_HZ / configTICK_RATE_HZ)
+
+// Prototypes for the power management.
+extern void PowerInit(void);
+extern uint32_t PowerSleep(void);
+extern void PowerReport(void);
+extern uint32_t PowerPercent(uint64_t ui64Part, uint64_t ui64Whole);
+
+#endif // __POWER_H__
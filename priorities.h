@@ -6,8 +6,27 @@
 // The priorities of the various tasks.
 //
 //*****************************************************************************
-#define PRIORITY_SWITCH_SENSOR_TASK    2
-#define PRIORITY_SENSOR_TASK       1
+#define PRIORITY_SENSOR_TASK       2
+#define PRIORITY_LOG_TASK          1
+
+//*****************************************************************************
+//
+// The NVIC priorities (0-7) of the interrupts that call FreeRTOS FromISR
+// functions.  These must not be more urgent (numerically lower) than
+// configMAX_SYSCALL_INTERRUPT_PRIORITY, which is 5.
+//
+//*****************************************************************************
+#define PRIORITY_ACCELEROMETER_INT 5
+#define PRIORITY_LIGHTSENSOR_INT   6
+#define PRIORITY_BUTTON_INT        6
+
+//
+// The UART0 interrupt calls the receive line callback, which posts to the
+// sensor task's queue with the FromISR API, so it must stay at or below
+// configMAX_SYSCALL_INTERRUPT_PRIORITY like the interrupts above. Being
+// maskable by critical sections also guards its transmit ring.
+//
+#define PRIORITY_UART_INT          7
 
 
 #endif // __PRIORITIES_H__
@@ -0,0 +1,165 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "atomic.h"
+#include "ring.h"
+
+//*****************************************************************************
+//
+// Initializes a ring over pvBuf, which holds ui32Count items of
+// ui32ItemSize bytes; ui32Count must be a power of two.
+//
+//*****************************************************************************
+void
+RingInit(tRing *psRing, void *pvBuf, uint32_t ui32ItemSize,
+         uint32_t ui32Count)
+{
+    psRing->pui8Buf = pvBuf;
+    psRing->ui32ItemSize = ui32ItemSize;
+    psRing->ui32Count = ui32Count;
+    psRing->ui32Head = 0;
+    psRing->ui32Tail = 0;
+}
+
+//*****************************************************************************
+//
+// Producer: points *ppvSpan at the next free item and returns how many free
+// items follow it without wrapping.
+//
+//*****************************************************************************
+uint32_t
+RingWriteSpan(tRing *psRing, void **ppvSpan)
+{
+    uint32_t ui32Head, ui32Index, ui32Free;
+
+    ui32Head = psRing->ui32Head;
+    ui32Index = ui32Head & (psRing->ui32Count - 1);
+    ui32Free = psRing->ui32Count - (ui32Head - psRing->ui32Tail);
+    if(ui32Free > (psRing->ui32Count - ui32Index))
+    {
+        ui32Free = psRing->ui32Count - ui32Index;
+    }
+
+    //
+    // The consumer has finished with the items behind its tail.
+    //
+    AtomicBarrier();
+
+    *ppvSpan = psRing->pui8Buf + (ui32Index * psRing->ui32ItemSize);
+    return(ui32Free);
+}
+
+//*****************************************************************************
+//
+// Producer: publishes ui32Items written into the span.
+//
+//*****************************************************************************
+void
+RingWriteCommit(tRing *psRing, uint32_t ui32Items)
+{
+    //
+    // The items must be in memory before the consumer can see them.
+    //
+    AtomicBarrier();
+    psRing->ui32Head += ui32Items;
+}
+
+//*****************************************************************************
+//
+// Consumer: points *ppvSpan at the oldest item and returns how many items
+// follow it without wrapping.
+//
+//*****************************************************************************
+uint32_t
+RingReadSpan(tRing *psRing, void **ppvSpan)
+{
+    uint32_t ui32Tail, ui32Index, ui32Used;
+
+    ui32Tail = psRing->ui32Tail;
+    ui32Index = ui32Tail & (psRing->ui32Count - 1);
+    ui32Used = psRing->ui32Head - ui32Tail;
+    if(ui32Used > (psRing->ui32Count - ui32Index))
+    {
+        ui32Used = psRing->ui32Count - ui32Index;
+    }
+
+    //
+    // Read the items only after the head that published them.
+    //
+    AtomicBarrier();
+
+    *ppvSpan = psRing->pui8Buf + (ui32Index * psRing->ui32ItemSize);
+    return(ui32Used);
+}
+
+//*****************************************************************************
+//
+// Consumer: gives ui32Items read from the span back to the producer.
+//
+//*****************************************************************************
+void
+RingReadCommit(tRing *psRing, uint32_t ui32Items)
+{
+    //
+    // Finish reading the items before the producer may overwrite them.
+    //
+    AtomicBarrier();
+    psRing->ui32Tail += ui32Items;
+}
+
+//*****************************************************************************
+//
+// Producer: copies in one item. Returns false if the ring is full.
+//
+//*****************************************************************************
+bool
+RingWrite(tRing *psRing, const void *pvItem)
+{
+    uint8_t *pui8Span;
+    uint32_t i;
+
+    if(RingWriteSpan(psRing, (void **)&pui8Span) == 0)
+    {
+        return(false);
+    }
+    for(i = 0; i < psRing->ui32ItemSize; i++)
+    {
+        pui8Span[i] = ((const uint8_t *)pvItem)[i];
+    }
+    RingWriteCommit(psRing, 1);
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Consumer: copies out the oldest item. Returns false if the ring is empty.
+//
+//*****************************************************************************
+bool
+RingRead(tRing *psRing, void *pvItem)
+{
+    uint8_t *pui8Span;
+    uint32_t i;
+
+    if(RingReadSpan(psRing, (void **)&pui8Span) == 0)
+    {
+        return(false);
+    }
+    for(i = 0; i < psRing->ui32ItemSize; i++)
+    {
+        ((uint8_t *)pvItem)[i] = pui8Span[i];
+    }
+    RingReadCommit(psRing, 1);
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Returns the number of items waiting. Exact for the consumer; a lower
+// bound on the free space for the producer.
+//
+//*****************************************************************************
+uint32_t
+RingUsed(const tRing *psRing)
+{
+    return(psRing->ui32Head - psRing->ui32Tail);
+}
@@ -0,0 +1,38 @@
+#ifndef __RING_H__
+#define __RING_H__
+
+//*****************************************************************************
+//
+// A single-producer, single-consumer ring of fixed-size items, for moving
+// data from an interrupt handler to a task without a critical section or a
+// kernel call per item. Exactly one context may write and one may read; the
+// producer only ever stores ui32Head and the consumer only ui32Tail, so a
+// barrier between the items and the index is all the ordering needed.
+//
+// The span calls give direct access to the contiguous run of free items
+// (for writing) or waiting items (for reading) at the index, so a batch is
+// moved with one commit. A span ends at the end of the buffer; the rest of a
+// batch is in a second span from the start.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t *pui8Buf;
+    uint32_t ui32ItemSize;          // bytes per item
+    uint32_t ui32Count;             // items; a power of two
+    volatile uint32_t ui32Head;     // items ever written
+    volatile uint32_t ui32Tail;     // items ever read
+}
+tRing;
+
+extern void RingInit(tRing *psRing, void *pvBuf, uint32_t ui32ItemSize,
+                     uint32_t ui32Count);
+extern uint32_t RingWriteSpan(tRing *psRing, void **ppvSpan);
+extern void RingWriteCommit(tRing *psRing, uint32_t ui32Items);
+extern uint32_t RingReadSpan(tRing *psRing, void **ppvSpan);
+extern void RingReadCommit(tRing *psRing, uint32_t ui32Items);
+extern bool RingWrite(tRing *psRing, const void *pvItem);
+extern bool RingRead(tRing *psRing, void *pvItem);
+extern uint32_t RingUsed(const tRing *psRing);
+
+#endif // __RING_H__
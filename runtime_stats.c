@@ -0,0 +1,98 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_timer.h"
+#include "inc/hw_types.h"
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "log_task.h"
+#include "runtime_stats.h"
+
+//*****************************************************************************
+//
+// Text from the kernel's report functions. Only one task may report at a
+// time.
+//
+//*****************************************************************************
+static char g_pcRunTimeStatsBuffer[RUN_TIME_STATS_BUFFER_SIZE];
+
+//*****************************************************************************
+//
+// Starts the run-time counter. Called by vTaskStartScheduler().
+//
+//*****************************************************************************
+void
+RunTimeStatsInit(void)
+{
+    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_WTIMER0);
+
+    //
+    // In periodic down-count mode the prescaler divides the clock, so the
+    // 32-bit half of the wide timer can run slowly enough not to wrap for
+    // hours. No interrupt is needed.
+    //
+    ROM_TimerConfigure(WTIMER0_BASE, TIMER_CFG_SPLIT_PAIR |
+                       TIMER_CFG_A_PERIODIC);
+    ROM_TimerPrescaleSet(WTIMER0_BASE, TIMER_A,
+                         (ROM_SysCtlClockGet() / RUN_TIME_STATS_HZ) - 1);
+    ROM_TimerLoadSet(WTIMER0_BASE, TIMER_A, 0xFFFFFFFF);
+    ROM_TimerEnable(WTIMER0_BASE, TIMER_A);
+}
+
+//*****************************************************************************
+//
+// Returns the run-time counter, counting up. Called by the kernel on every
+// context switch, so it reads the register directly.
+//
+//*****************************************************************************
+unsigned long
+RunTimeStatsCounter(void)
+{
+    return(~HWREG(WTIMER0_BASE + TIMER_O_TAR));
+}
+
+//*****************************************************************************
+//
+// Logs the kernel's tab-separated report in pcText one line at a time. The
+// kernel ends lines with CR/LF; the logger adds its own CR.
+//
+//*****************************************************************************
+static void
+RunTimeStatsLog(char *pcText)
+{
+    char *pcLine;
+
+    for(pcLine = pcText; *pcText; pcText++)
+    {
+        if(*pcText == '\r')
+        {
+            *pcText = '\0';
+        }
+        else if(*pcText == '\n')
+        {
+            LogPrintf("%s\n", pcLine);
+            pcLine = pcText + 1;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Logs each task's share of the CPU since start-up, then its state,
+// priority and the least free stack it has had, in words.
+//
+//*****************************************************************************
+void
+RunTimeStatsReport(void)
+{
+    LogPrintf("task\t\tcount\t\tcpu\n");
+    vTaskGetRunTimeStats((signed char *)g_pcRunTimeStatsBuffer);
+    RunTimeStatsLog(g_pcRunTimeStatsBuffer);
+
+    LogPrintf("task\t\tstate\tpri\tstack\tnum\n");
+    vTaskList((signed char *)g_pcRunTimeStatsBuffer);
+    RunTimeStatsLog(g_pcRunTimeStatsBuffer);
+}
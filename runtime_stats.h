@@ -0,0 +1,25 @@
+#ifndef __RUNTIME_STATS_H__
+#define __RUNTIME_STATS_H__
+
+//*****************************************************************************
+//
+// FreeRTOS run-time statistics. Wide Timer 0A counts down from 0xFFFFFFFF at
+// RUN_TIME_STATS_HZ and the kernel charges each task for the counts between
+// switching it in and out. The counters are never reset, so the figures
+// cover the time since the scheduler started; at 100 kHz the counter wraps,
+// and the percentages stop meaning anything, after about 11.9 hours.
+//
+//*****************************************************************************
+#define RUN_TIME_STATS_HZ          100000
+
+// Room for one line of each report per task.
+#define RUN_TIME_STATS_MAX_TASKS   8
+#define RUN_TIME_STATS_BUFFER_SIZE (RUN_TIME_STATS_MAX_TASKS * 40)
+
+// Prototypes for the run-time statistics. The first two are called by the
+// kernel through FreeRTOSConfig.h, so the counter has the kernel's type.
+extern void RunTimeStatsInit(void);
+extern unsigned long RunTimeStatsCounter(void);
+extern void RunTimeStatsReport(void);
+
+#endif // __RUNTIME_STATS_H__
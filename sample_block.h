@@ -0,0 +1,39 @@
+#ifndef __SAMPLE_BLOCK_H__
+#define __SAMPLE_BLOCK_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "pool.h"
+
+//*****************************************************************************
+//
+// A block of samples in a pool block. Samples are written once, by the
+// driver or the uDMA, and from then on only the pointer moves: from the
+// driver to the Sensor task, and on to the logger in binary output. Whoever
+// holds the pointer owns the block and must pass it on or free it.
+//
+// The driver fills in the type, sample size and count; the Sensor task adds
+// the sequence, period and time before sending it on.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t ui8Type;                // telemetry stream type
+    uint8_t ui8SampleSize;          // bytes per sample
+    uint8_t ui8Count;               // samples in pui32Data
+    uint8_t ui8Sequence;            // telemetry record number
+    uint32_t ui32PeriodMs;          // time between samples
+    uint32_t ui32Time;              // ms since start-up of the last sample
+    uint32_t pui32Data[(POOL_BLOCK_SIZE - 12) / 4];
+}
+tSampleBlock;
+
+#define SAMPLE_BLOCK_DATA_SIZE     (POOL_BLOCK_SIZE - 12)
+
+// Takes and frees blocks, and finds the block around its data.
+#define SampleBlockAlloc()         ((tSampleBlock *)PoolAlloc())
+#define SampleBlockFree(psBlock)   PoolFree(psBlock)
+#define SampleBlockFromData(pvData)                                           \
+    ((tSampleBlock *)((uint8_t *)(pvData) - offsetof(tSampleBlock, pui32Data)))
+
+#endif // __SAMPLE_BLOCK_H__
@@ -0,0 +1,149 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "schedule.h"
+
+//*****************************************************************************
+//
+// Sets up a schedule for a sensor that takes a sample every ui32PeriodUs
+// and is serviced ui32Batch samples at a time. The period may be changed
+// later by writing ui32PeriodUs and calling ScheduleRestart().
+//
+//*****************************************************************************
+void
+ScheduleInit(tSchedule *psSchedule, uint32_t ui32PeriodUs, uint32_t ui32Batch,
+             bool bHardwarePaced, uint32_t ui32TickUs)
+{
+    psSchedule->ui32PeriodUs = ui32PeriodUs;
+    psSchedule->ui32Batch = ui32Batch;
+    psSchedule->ui32TickUs = ui32TickUs;
+    psSchedule->bHardwarePaced = bHardwarePaced;
+    psSchedule->ui32Deadline = 0;
+    psSchedule->ui32Residue = 0;
+}
+
+//*****************************************************************************
+//
+// Sets the first deadline of a sensor that has just started or changed its
+// period: one interval from now for a software-paced sensor, which starts
+// its grid here, and as after a service for a hardware-paced one.
+//
+//*****************************************************************************
+void
+ScheduleRestart(tSchedule *psSchedule, uint32_t ui32Now)
+{
+    uint32_t ui32IntervalUs;
+
+    if(psSchedule->bHardwarePaced)
+    {
+        ScheduleNext(psSchedule, ui32Now);
+        return;
+    }
+    ui32IntervalUs = psSchedule->ui32PeriodUs * psSchedule->ui32Batch;
+    psSchedule->ui32Deadline = ui32Now +
+                               (ui32IntervalUs / psSchedule->ui32TickUs);
+    psSchedule->ui32Residue = ui32IntervalUs % psSchedule->ui32TickUs;
+}
+
+//*****************************************************************************
+//
+// Sets the next deadline of a sensor serviced, or found late, at ui32Now.
+//
+//*****************************************************************************
+void
+ScheduleNext(tSchedule *psSchedule, uint32_t ui32Now)
+{
+    uint32_t ui32IntervalUs;
+
+    ui32IntervalUs = psSchedule->ui32PeriodUs * psSchedule->ui32Batch;
+
+    if(psSchedule->bHardwarePaced)
+    {
+        //
+        // The driver keeps time, but blocks only become visible on tick
+        // boundaries; allow one extra period, rounded up to ticks, and one
+        // tick for interrupt and scheduling latency before declaring the
+        // next batch late.
+        //
+        psSchedule->ui32Deadline = ui32Now + 1 +
+            ((ui32IntervalUs + psSchedule->ui32PeriodUs +
+              psSchedule->ui32TickUs - 1) / psSchedule->ui32TickUs);
+        psSchedule->ui32Residue = 0;
+        return;
+    }
+
+    //
+    // Keep to the original grid, carrying the part of a tick that the
+    // interval does not fill, so the rate does not drift.
+    //
+    psSchedule->ui32Residue += ui32IntervalUs;
+    psSchedule->ui32Deadline += psSchedule->ui32Residue /
+                                psSchedule->ui32TickUs;
+    psSchedule->ui32Residue %= psSchedule->ui32TickUs;
+
+    //
+    // Unless the task has fallen more than a whole interval behind; then
+    // start a new grid from now rather than read the sensor back to back.
+    // A deadline of now is just one service that was late by an interval.
+    //
+    if(ScheduleWait(psSchedule, ui32Now) < 0)
+    {
+        psSchedule->ui32Deadline = ui32Now +
+                                   (ui32IntervalUs / psSchedule->ui32TickUs);
+        psSchedule->ui32Residue = ui32IntervalUs % psSchedule->ui32TickUs;
+        if(psSchedule->ui32Deadline == ui32Now)
+        {
+            psSchedule->ui32Deadline++;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the ticks from ui32Now to the deadline; zero or less when it is
+// due.
+//
+//*****************************************************************************
+int32_t
+ScheduleWait(const tSchedule *psSchedule, uint32_t ui32Now)
+{
+    return((int32_t)(psSchedule->ui32Deadline - ui32Now));
+}
+
+//*****************************************************************************
+//
+// Returns the samples the period predicts in ui32Ms.
+//
+//*****************************************************************************
+uint32_t
+ScheduleExpected(const tSchedule *psSchedule, uint32_t ui32Ms)
+{
+    return(((uint64_t)ui32Ms * 1000) / psSchedule->ui32PeriodUs);
+}
+
+//*****************************************************************************
+//
+// Checks an achieved rate: true if ui32Samples in ui32Ms is within one
+// batch of what the period predicts.
+//
+//*****************************************************************************
+bool
+ScheduleRateOk(const tSchedule *psSchedule, uint32_t ui32Samples,
+               uint32_t ui32Ms)
+{
+    uint32_t ui32Expected;
+
+    ui32Expected = ScheduleExpected(psSchedule, ui32Ms);
+    return(((ui32Samples + psSchedule->ui32Batch) >= ui32Expected) &&
+           (ui32Samples <= (ui32Expected + psSchedule->ui32Batch)));
+}
+
+//*****************************************************************************
+//
+// Returns ui32Samples in ui32Ms as a rate in hundredths of a Hz.
+//
+//*****************************************************************************
+uint32_t
+ScheduleCentiHz(uint32_t ui32Samples, uint32_t ui32Ms)
+{
+    return(((uint64_t)ui32Samples * 100000) / ui32Ms);
+}
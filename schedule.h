@@ -0,0 +1,43 @@
+#ifndef __SCHEDULE_H__
+#define __SCHEDULE_H__
+
+//*****************************************************************************
+//
+// The deadline arithmetic of one sensor's sampling schedule, in kernel
+// ticks of ui32TickUs each. A software-paced sensor is read at its
+// deadlines, which stay on a fixed grid of ui32Batch * ui32PeriodUs so the
+// rate does not drift, even when that is not a whole number of ticks. A
+// hardware-paced sensor keeps its own time; its deadline only says when a
+// block is late.
+//
+// Ticks wrap, so deadlines are compared by signed difference. The period
+// times (ui32Batch + 1) must fit in 32 bits.
+//
+// This file builds both into the firmware and into the host test in tools/,
+// so it must not depend on anything target specific.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32PeriodUs;          // time between samples
+    uint32_t ui32Batch;             // samples per service
+    uint32_t ui32TickUs;            // length of a tick
+    bool bHardwarePaced;            // the driver keeps time
+    uint32_t ui32Deadline;          // tick at which the next service is due
+    uint32_t ui32Residue;           // us by which the grid lies past it
+}
+tSchedule;
+
+extern void ScheduleInit(tSchedule *psSchedule, uint32_t ui32PeriodUs,
+                         uint32_t ui32Batch, bool bHardwarePaced,
+                         uint32_t ui32TickUs);
+extern void ScheduleRestart(tSchedule *psSchedule, uint32_t ui32Now);
+extern void ScheduleNext(tSchedule *psSchedule, uint32_t ui32Now);
+extern int32_t ScheduleWait(const tSchedule *psSchedule, uint32_t ui32Now);
+extern uint32_t ScheduleExpected(const tSchedule *psSchedule,
+                                 uint32_t ui32Ms);
+extern bool ScheduleRateOk(const tSchedule *psSchedule, uint32_t ui32Samples,
+                           uint32_t ui32Ms);
+extern uint32_t ScheduleCentiHz(uint32_t ui32Samples, uint32_t ui32Ms);
+
+#endif // __SCHEDULE_H__
@@ -0,0 +1,57 @@
+#ifndef __SENSOR_DRIVER_H__
+#define __SENSOR_DRIVER_H__
+
+#include "sample_block.h"
+
+//*****************************************************************************
+//
+// A sensor driver, built on the BSP functions. The Sensor task only talks to
+// sensors through this table, so a new sensor is added by writing its
+// driver and listing it in g_psSensorDrivers[]; the task itself is unchanged.
+//
+// pfnInit    Initializes the hardware. A hardware-paced driver calls pfnBlock
+//            from its interrupt with each block it fills, and the block
+//            belongs to the Sensor task from then on.
+// pfnStart   Starts sampling.
+// pfnSetPeriod Changes the time between samples, in us, while sampling.
+//            The driver clamps the period to what the sensor can do and
+//            returns the period it will actually run at.
+// pfnRead    For a software-paced driver, returns a block holding the
+//            newest samples, or 0 if there are none or no block is free.
+//            The caller owns the block.
+// pfnArgs    Fills in the log arguments for sample ui32Index of a batch and
+//            returns how many there are. The sample is logged as message
+//            ui32Format from log_formats.h.
+//
+// Samples are written once, into a block from the pool (see sample_block.h),
+// with ui8Type and ui8SampleSize filled in. In binary output the block goes
+// to the logger as it is and becomes one telemetry record (see telemetry.h).
+//
+// One service costs at most a read call per batch plus one argument call
+// per printed sample. ui32PeriodUs is only the period the sensor starts at;
+// the Sensor task keeps track of the current one.
+//
+//*****************************************************************************
+typedef struct
+{
+    const char *pcName;
+    uint32_t ui32PeriodUs;          // initial time between samples, in us
+    uint32_t ui32Batch;             // samples per block
+    bool bHardwarePaced;            // driver keeps time and calls pfnBlock
+    uint8_t ui8Type;                // telemetry stream type
+    uint8_t ui8SampleSize;          // bytes per sample in a block
+    void (*pfnInit)(void (*pfnBlock)(tSampleBlock *psBlock));
+    void (*pfnStart)(void);
+    uint32_t (*pfnSetPeriod)(uint32_t ui32PeriodUs);
+    tSampleBlock *(*pfnRead)(void);
+    uint32_t ui32Format;
+    uint32_t (*pfnArgs)(uint32_t *pui32Args, const void *pvBatch,
+                        uint32_t ui32Index);
+}
+tSensorDriver;
+
+// The registered sensors.
+#define NUM_SENSOR_DRIVERS         2
+extern const tSensorDriver g_psSensorDrivers[NUM_SENSOR_DRIVERS];
+
+#endif
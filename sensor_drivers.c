@@ -0,0 +1,188 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "priorities.h"
+#include "inc/bsp.h"
+#include "telemetry.h"
+#include "log_task.h"
+#include "sensor_driver.h"
+
+//*****************************************************************************
+//
+// The rate, in Hz, at which Timer0A triggers accelerometer conversions.
+// uDMA moves the samples, so the CPU only sees one interrupt per block.
+//
+//*****************************************************************************
+#define ACCEL_SAMPLE_RATE          100
+
+//*****************************************************************************
+//
+// The period, in us, at which the light sensor is sampled. The OPT3001
+// converts continuously a little faster than this, so a fresh reading is
+// always waiting when the deadline comes round. It cannot convert faster
+// than every 100 ms; the slowest period keeps the Sensor task's deadline
+// arithmetic in range.
+//
+//*****************************************************************************
+#define LIGHT_SAMPLE_PERIOD_US     1000000
+#define LIGHT_PERIOD_MIN_US        100000
+#define LIGHT_PERIOD_MAX_US        60000000
+
+//*****************************************************************************
+//
+// Accelerometer driver. Timer0A paces the ADC and the uDMA fills pool
+// blocks of ACCEL_BLOCK_SAMPLES x,y,z triples directly, so the samples are
+// never copied on the way to the log.
+//
+//*****************************************************************************
+static void (*g_pfnAccelBlock)(tSampleBlock *psBlock);
+
+// Both run in the ADC interrupt.
+static uint16_t *AccelGetBlock(void)
+{
+    tSampleBlock *psBlock = SampleBlockAlloc();
+
+    return(psBlock ? (uint16_t *)psBlock->pui32Data : 0);
+}
+
+static void AccelBlockDone(uint16_t *pui16Samples)
+{
+    tSampleBlock *psBlock = SampleBlockFromData(pui16Samples);
+
+    psBlock->ui8Type = TELEMETRY_TYPE_ACCEL;
+    psBlock->ui8SampleSize = 3 * sizeof(uint16_t);
+    psBlock->ui8Count = ACCEL_BLOCK_SAMPLES;
+    g_pfnAccelBlock(psBlock);
+}
+
+static void AccelInit(void (*pfnBlock)(tSampleBlock *psBlock))
+{
+    BSP_Accelerometer_Init();
+    g_pfnAccelBlock = pfnBlock;
+}
+
+static void AccelStart(void)
+{
+    BSP_Accelerometer_InitDMABlocks(ACCEL_SAMPLE_RATE, AccelGetBlock,
+                                    AccelBlockDone,
+                                    PRIORITY_ACCELEROMETER_INT);
+}
+
+static uint32_t AccelSetPeriod(uint32_t ui32PeriodUs)
+{
+    uint32_t ui32Rate;
+
+    // Timer0A is programmed in Hz, so round to the nearest whole rate.
+    ui32Rate = (ui32PeriodUs == 0) ? ACCEL_RATE_MAX :
+               ((1000000 + (ui32PeriodUs / 2)) / ui32PeriodUs);
+    if(ui32Rate < ACCEL_RATE_MIN)
+    {
+        ui32Rate = ACCEL_RATE_MIN;
+    }
+    if(ui32Rate > ACCEL_RATE_MAX)
+    {
+        ui32Rate = ACCEL_RATE_MAX;
+    }
+    BSP_Accelerometer_SetRate(ui32Rate);
+    return(1000000 / ui32Rate);
+}
+
+static uint32_t AccelArgs(uint32_t *pui32Args, const void *pvBatch,
+                          uint32_t ui32Index)
+{
+    const uint16_t *pui16Sample = (const uint16_t *)pvBatch + (3 * ui32Index);
+
+    // DMA blocks hold raw 12-bit codes; print them as 10-bit.
+    pui32Args[0] = pui16Sample[0] >> 2;
+    pui32Args[1] = pui16Sample[1] >> 2;
+    pui32Args[2] = pui16Sample[2] >> 2;
+    return(3);
+}
+
+//*****************************************************************************
+//
+// Light sensor driver. The OPT3001 converts continuously and its INT line
+// re-arms each conversion; the task reads the newest value at its deadline.
+//
+//*****************************************************************************
+static uint32_t g_ui32LightConversion = LIGHT_CONVERSION_800MS;
+
+static void LightInit(void (*pfnBlock)(tSampleBlock *psBlock))
+{
+    BSP_LightSensor_Init();
+
+    // The OPT3001 supports fast mode, which makes each register access about
+    // four times shorter than the 100 kbps default.
+    BSP_I2C_SetSpeed(I2C_SPEED_FAST);
+
+    // Software paced, so no completion callback is needed.
+    BSP_LightSensor_InitInterrupt(0, PRIORITY_LIGHTSENSOR_INT);
+}
+
+static void LightStart(void)
+{
+    // Program the OPT3001 once; from now on each conversion is just read out.
+    BSP_LightSensor_StartContinuous(g_ui32LightConversion);
+}
+
+static uint32_t LightSetPeriod(uint32_t ui32PeriodUs)
+{
+    if(ui32PeriodUs < LIGHT_PERIOD_MIN_US)
+    {
+        ui32PeriodUs = LIGHT_PERIOD_MIN_US;
+    }
+    if(ui32PeriodUs > LIGHT_PERIOD_MAX_US)
+    {
+        ui32PeriodUs = LIGHT_PERIOD_MAX_US;
+    }
+
+    // The long conversion is less noisy, but only keeps ahead of periods of
+    // a second or more.
+    g_ui32LightConversion = (ui32PeriodUs < LIGHT_SAMPLE_PERIOD_US) ?
+                            LIGHT_CONVERSION_100MS : LIGHT_CONVERSION_800MS;
+    BSP_LightSensor_StopContinuous();
+    BSP_LightSensor_StartContinuous(g_ui32LightConversion);
+    return(ui32PeriodUs);
+}
+
+static tSampleBlock *LightRead(void)
+{
+    tSampleBlock *psBlock;
+
+    // With no block free the reading waits in the OPT3001 for next time.
+    if(!BSP_LightSensor_Ready() || ((psBlock = SampleBlockAlloc()) == 0))
+    {
+        return(0);
+    }
+    psBlock->ui8Type = TELEMETRY_TYPE_LIGHT;
+    psBlock->ui8SampleSize = sizeof(uint32_t);
+    psBlock->ui8Count = BSP_LightSensor_End(&psBlock->pui32Data[0]);
+    if(psBlock->ui8Count == 0)
+    {
+        SampleBlockFree(psBlock);
+        return(0);
+    }
+    return(psBlock);
+}
+
+static uint32_t LightArgs(uint32_t *pui32Args, const void *pvBatch,
+                          uint32_t ui32Index)
+{
+    pui32Args[0] = ((const uint32_t *)pvBatch)[ui32Index];
+    return(1);
+}
+
+//*****************************************************************************
+//
+// The registered sensors, in the order the Sensor task services them.
+//
+//*****************************************************************************
+const tSensorDriver g_psSensorDrivers[NUM_SENSOR_DRIVERS] =
+{
+    { "accelerometer", 1000000 / ACCEL_SAMPLE_RATE, ACCEL_BLOCK_SAMPLES, true,
+      TELEMETRY_TYPE_ACCEL, 3 * sizeof(uint16_t),
+      AccelInit, AccelStart, AccelSetPeriod, 0, LOG_ACCEL_SAMPLE, AccelArgs },
+    { "light", LIGHT_SAMPLE_PERIOD_US, 1, false,
+      TELEMETRY_TYPE_LIGHT, sizeof(uint32_t),
+      LightInit, LightStart, LightSetPeriod, LightRead, LOG_LIGHT_SAMPLE,
+      LightArgs },
+};
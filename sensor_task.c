@@ -6,28 +6,70 @@
 #include "driverlib/gpio.h"
 #include "driverlib/rom.h"
 #include "drivers/buttons.h"
-#include "utils/uartstdio.h"
+#include "utils/ustdlib.h"
+#include "console.h"
+#include "log_task.h"
+#include "pool.h"
+#include "power.h"
+#include "ring.h"
+#include "runtime_stats.h"
+#include "schedule.h"
+#include "switches.h"
+#include "telemetry.h"
+#include "uart_tx.h"
 #include "priorities.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
 #include "semphr.h"
-#include "inc/bsp.h"
+#include "sensor_driver.h"
 
 //*****************************************************************************
 //
-// The stack size for the Sensor task.
+// The stack size for the Sensor task, and the stack itself, which is
+// allocated statically rather than from the FreeRTOS heap. The tasks
+// command runs the kernel's sprintf()-based reports on this stack.
 //
 //*****************************************************************************
-#define SENSORTASKSTACKSIZE        128         // Stack size in words
+#define SENSORTASKSTACKSIZE        256         // Stack size in words
+static portSTACK_TYPE g_pui32SensorTaskStack[SENSORTASKSTACKSIZE];
 
 //*****************************************************************************
 //
-// The item size and queue size for the Sensor message queue.
+// The item size and queue size for the Sensor message queue. Besides the
+// button commands it carries the driver events posted from interrupts.
 //
 //*****************************************************************************
 #define SENSOR_ITEM_SIZE           sizeof(uint8_t)
-#define SENSOR_QUEUE_SIZE          5
+#define SENSOR_QUEUE_SIZE          8
+
+//*****************************************************************************
+//
+// Filled blocks waiting in each sensor's ring; a power of two. The blocks
+// travel from the driver's interrupt to the task by pointer, through a
+// lock-free ring (see ring.h), and the queue only wakes the task when a
+// ring goes from empty to not.
+//
+//*****************************************************************************
+#define SENSOR_RING_SIZE           8
+
+//*****************************************************************************
+//
+// Set to true to start up sending binary telemetry (see telemetry.h)
+// instead of text.
+//
+//*****************************************************************************
+#define SENSOR_BINARY_OUTPUT       false
+
+//*****************************************************************************
+//
+// Length, in ms, of each half of the output benchmark; 0 skips it. When
+// set, the Sensor task first measures how many samples per second the text
+// and the binary output paths sustain at the current baud rate, by pushing
+// synthetic blocks of the first sensor as fast as the log drains.
+//
+//*****************************************************************************
+#define SENSOR_BENCHMARK_MS        0
 
 //*****************************************************************************
 //
@@ -36,140 +78,821 @@
 //*****************************************************************************
 xQueueHandle g_pSensorQueue;
 
+//*****************************************************************************
 //
-// Sensors [Accelerometer, Light] listed in alphabetical order.
-// Can add more sensors once this works
+// The sampling schedule. Every registered sensor runs concurrently with its
+// own period and its own deadline for the next sample. A hardware-paced
+// sensor is serviced when its driver posts an event and only misses a
+// deadline if that event is late; a software-paced one is read by the task
+// when its deadline arrives. The deadline arithmetic is in schedule.c.
 //
-static bool sensors[2] = { false, false };
-static uint8_t SensorIndx;
+//*****************************************************************************
+typedef struct
+{
+    const tSensorDriver *psDriver;
+    bool bEnabled;              // print the samples; otherwise discard them
+    tSchedule sSchedule;        // current period and next deadline
+    uint32_t ui32Samples;       // samples since the last rate report
+    uint32_t ui32Missed;        // deadlines missed since the last report
+    uint8_t ui8Sequence;        // next telemetry record number
+    tRing sBlocks;              // filled blocks from the driver's interrupt
+    tSampleBlock *ppsBlocks[SENSOR_RING_SIZE];
+}
+tSensorSchedule;
 
-extern xSemaphoreHandle g_pUARTSemaphore;
+static tSensorSchedule g_psSensors[NUM_SENSOR_DRIVERS];
+
+//
+// The tick count at the start of the current rate report window.
+//
+static portTickType g_xRateStart;
+
+//
+// Send samples as binary telemetry records instead of text lines.
+//
+static bool g_bSensorBinary = SENSOR_BINARY_OUTPUT;
+
+//
+// The command console on UART0 (see SensorConsole()).
+//
+static tConsole g_sConsole;
+
+extern uint32_t CPULoadGet(void);
 
 //*****************************************************************************
 //
-// This task toggles the user selected sensor. User
-// can make the selections by pressing the left and right buttons.
+// Called from a hardware-paced driver's interrupt with a filled block.
+// Passes the block to the Sensor task through the sensor's ring; if the
+// ring is full the block goes back to the pool and the sensor misses its
+// deadline. Only the block that finds the ring empty costs a queue post;
+// if that post fails, the task still finds the block at the deadline.
 //
 //*****************************************************************************
-static void SensorTask(void *pvParameters)
+static void SensorBlockFromISR(tSampleBlock *psBlock)
 {
-    portTickType ui32WakeTime;
-    uint8_t i8Message;
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+    uint8_t ui8Event = SENSOR_EVENT_BLOCK;
+    tSensorSchedule *psSensor;
+    bool bWasEmpty;
+    uint32_t i;
 
-    // Get the current tick count.
-    ui32WakeTime = xTaskGetTickCount();
+    for(i = 0; i < NUM_SENSOR_DRIVERS; i++)
+    {
+        if(g_psSensors[i].psDriver->ui8Type == psBlock->ui8Type)
+        {
+            break;
+        }
+    }
+    if(i == NUM_SENSOR_DRIVERS)
+    {
+        SampleBlockFree(psBlock);
+        return;
+    }
+    psSensor = &g_psSensors[i];
 
-    // Loop forever.
-    while(1)
+    bWasEmpty = (RingUsed(&psSensor->sBlocks) == 0);
+    if(!RingWrite(&psSensor->sBlocks, &psBlock))
+    {
+        SampleBlockFree(psBlock);
+        return;
+    }
+    if(bWasEmpty)
     {
-        // Read the next message, if available on queue.
-        if(xQueueReceive(g_pSensorQueue, &i8Message, 0) == pdPASS)
+        xQueueSendToBackFromISR(g_pSensorQueue, &ui8Event,
+                                &xHigherPriorityTaskWoken);
+        portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+//*****************************************************************************
+//
+// Called from the UART0 interrupt when a command line has been received.
+// If the queue is full the event is dropped and the line waits in the
+// receive ring until the next one.
+//
+//*****************************************************************************
+static void SensorConsoleFromISR(void)
+{
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+    uint8_t ui8Event = SENSOR_EVENT_CONSOLE;
+
+    xQueueSendToBackFromISR(g_pSensorQueue, &ui8Event,
+                            &xHigherPriorityTaskWoken);
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+//*****************************************************************************
+//
+// Logs a batch one message per sample, packing as many whole messages into
+// each log record as fit. A message too long for a record of its own is
+// dropped, and counted as such.
+//
+//*****************************************************************************
+static void SensorPrint(const tSensorDriver *psDriver, const void *pvBatch,
+                        uint32_t ui32Count)
+{
+    char pcRecord[LOG_RECORD_SIZE];
+    uint32_t pui32Args[LOG_MAX_ARGS] = { 0 };
+    uint32_t ui32Used = 0, ui32Len, ui32Args, i;
+
+    for(i = 0; i < ui32Count; i++)
+    {
+        ui32Args = psDriver->pfnArgs(pui32Args, pvBatch, i);
+        ui32Len = LogEncode(pcRecord + ui32Used, sizeof(pcRecord) - ui32Used,
+                            psDriver->ui32Format, pui32Args, ui32Args);
+        if((ui32Len == 0) && (ui32Used != 0))
         {
-            // If left button, switch to other sensor
-            if(i8Message == LEFT_BUTTON)
+            LogWriteEncoded(pcRecord, ui32Used);
+            ui32Used = 0;
+            ui32Len = LogEncode(pcRecord, sizeof(pcRecord),
+                                psDriver->ui32Format, pui32Args, ui32Args);
+        }
+        if(ui32Len == 0)
+        {
+            LogDrop();
+        }
+        ui32Used += ui32Len;
+    }
+    if(ui32Used != 0)
+    {
+        LogWriteEncoded(pcRecord, ui32Used);
+    }
+}
+
+//*****************************************************************************
+//
+// Sends a block to the logger as one telemetry record, which passes the
+// block on. Its last sample was taken at xNow. The record carries the
+// period to the nearest ms.
+//
+//*****************************************************************************
+static void SensorSend(tSensorSchedule *psSensor, tSampleBlock *psBlock,
+                       portTickType xNow)
+{
+    psBlock->ui8Sequence = psSensor->ui8Sequence++;
+    psBlock->ui32PeriodMs = (psSensor->sSchedule.ui32PeriodUs + 500) / 1000;
+    psBlock->ui32Time = xNow * portTICK_RATE_MS;
+    LogWriteBlock(psBlock);
+}
+
+//*****************************************************************************
+//
+// Selects text or binary telemetry output for all sensors.
+//
+//*****************************************************************************
+void SensorOutputBinary(bool bBinary)
+{
+    g_bSensorBinary = bBinary;
+}
+
+//*****************************************************************************
+//
+// Measures the sustained output rate of the text and the binary paths for
+// ui32Ms each and logs the results. A block is only pushed once the log
+// queue has room for all of it, so the rate is what the UART carries rather
+// than what the queue can absorb.
+//
+//*****************************************************************************
+void SensorBenchmark(uint32_t ui32Ms)
+{
+    tSensorSchedule sBench = g_psSensors[0];
+    const tSensorDriver *psDriver = sBench.psDriver;
+    tSampleBlock *psBlock;
+    portTickType xStart, xTicks;
+    uint32_t ui32Count, ui32Samples, ui32Dropped, ui32Pass, i;
+    bool bBinary;
+
+    ui32Count = psDriver->ui32Batch;
+    if((ui32Count * psDriver->ui8SampleSize) > SAMPLE_BLOCK_DATA_SIZE)
+    {
+        ui32Count = SAMPLE_BLOCK_DATA_SIZE / psDriver->ui8SampleSize;
+    }
+
+    // Text first, then binary.
+    for(ui32Pass = 0; ui32Pass < 2; ui32Pass++)
+    {
+        bBinary = (ui32Pass == 1);
+        ui32Samples = 0;
+        ui32Dropped = LogDropped();
+        xStart = xTaskGetTickCount();
+        while((xTaskGetTickCount() - xStart) < (ui32Ms / portTICK_RATE_MS))
+        {
+            // The sensors keep filling blocks while this runs, so the pool
+            // may be short for a moment.
+            if((LogFree() < (LOG_QUEUE_SIZE / 2)) ||
+               (LogBlockFree() < (LOG_BLOCK_QUEUE_SIZE / 2)) ||
+               ((psBlock = SampleBlockAlloc()) == 0))
             {
-                // Update to stop reading from current sensor
-                sensors[SensorIndx] = false;
-
-                // Update the index to next sensor
-                SensorIndx++;
-                if(SensorIndx > 1)
-                {
-                    SensorIndx = 0;
-                }
-
-                // Update the buffer to turn on the next sensor
-                sensors[SensorIndx] = true;
-
-                if (SensorIndx == 0) {
-                    xSemaphoreTake(g_pUARTSemaphore, portMAX_DELAY);
-                    UARTprintf("Reading from accelerometer\n");
-                    xSemaphoreGive(g_pUARTSemaphore);
-                }
-                else if (SensorIndx == 1) {
-                    xSemaphoreTake(g_pUARTSemaphore, portMAX_DELAY);
-                    UARTprintf("Reading from light sensor\n");
-                    xSemaphoreGive(g_pUARTSemaphore);
-                }
+                vTaskDelay(1);
+                continue;
+            }
 
+            // Synthetic samples, written once as a driver would.
+            psBlock->ui8Type = psDriver->ui8Type;
+            psBlock->ui8SampleSize = psDriver->ui8SampleSize;
+            psBlock->ui8Count = ui32Count;
+            for(i = 0; i < (ui32Count * psDriver->ui8SampleSize); i++)
+            {
+                ((uint8_t *)psBlock->pui32Data)[i] = i * 37;
             }
 
-            if(i8Message == RIGHT_BUTTON)
+            if(bBinary)
+            {
+                SensorSend(&sBench, psBlock, xTaskGetTickCount());
+            }
+            else
             {
-                // Guard UART from concurrent access. Print the currently
-                // blinking frequency.
-                xSemaphoreTake(g_pUARTSemaphore, portMAX_DELAY);
-                UARTprintf("Just pressed right button.\n");
-                xSemaphoreGive(g_pUARTSemaphore);
+                SensorPrint(psDriver, psBlock->pui32Data, ui32Count);
+                SampleBlockFree(psBlock);
             }
+            ui32Samples += ui32Count;
         }
 
-        // Read and print from the selected sensor
-        // Accelerometer
-        if (sensors[0] == true) {
-            // Get a sensor reading
-            uint16_t x,y,z;
-            BSP_Accelerometer_Input(&x, &y, &z);
+        // Include the time to get the backlog onto the wire.
+        while((LogFree() != LOG_QUEUE_SIZE) ||
+              (LogBlockFree() != LOG_BLOCK_QUEUE_SIZE) ||
+              (UARTTxSpace() != UART_TX_BUFFER_SIZE))
+        {
+            vTaskDelay(1);
+        }
+        xTicks = xTaskGetTickCount() - xStart;
 
-            // Guard UART from concurrent access.
-            xSemaphoreTake(g_pUARTSemaphore, portMAX_DELAY);
+        LogPrintf("bench %s: %d samples/s at %d baud, %d dropped\n",
+                  bBinary ? "binary" : "text",
+                  (ui32Samples * 1000) / (xTicks * portTICK_RATE_MS),
+                  UARTTxBaud(), LogDropped() - ui32Dropped);
+    }
+}
 
-            // Print the reading
-            UARTprintf("[x,y,z] = [%d, %d, %d]\n", x,y,z);
+//*****************************************************************************
+//
+// Services one sensor with psBlock, which it takes ownership of, and sets
+// its next deadline. Every block is passed on or freed promptly, printed or
+// not, so the pool never runs dry. A sensor with no block at its deadline
+// has missed it.
+//
+//*****************************************************************************
+static void SensorService(tSensorSchedule *psSensor, tSampleBlock *psBlock,
+                          portTickType xNow)
+{
+    const tSensorDriver *psDriver = psSensor->psDriver;
+
+    if(psBlock == 0)
+    {
+        psSensor->ui32Missed++;
+    }
+    else
+    {
+        psSensor->ui32Samples += psBlock->ui8Count;
+        if(psSensor->bEnabled && g_bSensorBinary)
+        {
+            SensorSend(psSensor, psBlock, xNow);
+        }
+        else
+        {
+            if(psSensor->bEnabled)
+            {
+                SensorPrint(psDriver, psBlock->pui32Data, psBlock->ui8Count);
+            }
+            SampleBlockFree(psBlock);
         }
+    }
+    ScheduleNext(&psSensor->sSchedule, xNow);
+}
 
-        // Light Sensor
-        else if (sensors[1] == true) {
-            // Get a sensor reading
-            uint32_t light;
-            light = BSP_LightSensor_Input();
+//*****************************************************************************
+//
+// Services every block waiting in a sensor's ring, taking the whole run in
+// one span.
+//
+//*****************************************************************************
+static void SensorDrain(tSensorSchedule *psSensor, portTickType xNow)
+{
+    tSampleBlock **ppsBlocks;
+    uint32_t ui32Count, i;
 
-            // Guard UART from concurrent access.
-            xSemaphoreTake(g_pUARTSemaphore, portMAX_DELAY);
+    while((ui32Count = RingReadSpan(&psSensor->sBlocks,
+                                    (void **)&ppsBlocks)) != 0)
+    {
+        for(i = 0; i < ui32Count; i++)
+        {
+            SensorService(psSensor, ppsBlocks[i], xNow);
+        }
+        RingReadCommit(&psSensor->sBlocks, ui32Count);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the number of ticks until the earliest deadline.
+//
+//*****************************************************************************
+static portTickType SensorNextTimeout(portTickType xNow)
+{
+    portBASE_TYPE xWait, xMin = portMAX_DELAY >> 1;
+    uint32_t i;
 
-            // Print the reading
-            UARTprintf("light = %d\n", light);
+    for(i = 0; i < NUM_SENSOR_DRIVERS; i++)
+    {
+        xWait = ScheduleWait(&g_psSensors[i].sSchedule, xNow);
+        if(xWait < xMin)
+        {
+            xMin = xWait;
         }
+    }
+    return((xMin > 0) ? (portTickType)xMin : 0);
+}
+
+//*****************************************************************************
+//
+// Reports the rate each sensor achieved since the previous report, next to
+// the rate it was asked for. The check passes if the sample count is within
+// one batch of what the requested period predicts for the window. Rates are
+// in hundredths of a Hz.
+//
+//*****************************************************************************
+static void SensorRateReport(void)
+{
+    portTickType xNow;
+    uint32_t i, ui32Ms, ui32CentiHz, ui32WantCentiHz;
+    tSensorSchedule *psSensor;
 
-        xSemaphoreGive(g_pUARTSemaphore);
+    xNow = xTaskGetTickCount();
+    ui32Ms = (xNow - g_xRateStart) * portTICK_RATE_MS;
+    g_xRateStart = xNow;
+    if(ui32Ms == 0)
+    {
+        return;
+    }
 
+    LOG2(LOG_CPU_LOAD, CPULoadGet(), LogDropped());
+    PowerReport();
+    for(i = 0; i < NUM_SENSOR_DRIVERS; i++)
+    {
+        psSensor = &g_psSensors[i];
+        ui32CentiHz = ScheduleCentiHz(psSensor->ui32Samples, ui32Ms);
+        ui32WantCentiHz = 100000000 / psSensor->sSchedule.ui32PeriodUs;
+        LogPrintf("%s: %d.%02d Hz (want %d.%02d), %d missed, %s\n",
+                  psSensor->psDriver->pcName, ui32CentiHz / 100,
+                  ui32CentiHz % 100, ui32WantCentiHz / 100,
+                  ui32WantCentiHz % 100, psSensor->ui32Missed,
+                  ScheduleRateOk(&psSensor->sSchedule, psSensor->ui32Samples,
+                                 ui32Ms) ? "ok" : "FAIL");
+        psSensor->ui32Samples = 0;
+        psSensor->ui32Missed = 0;
     }
 }
 
 //*****************************************************************************
 //
-// Initializes the Sensor task.
+// Steps to the next combination of printed sensors, counting down through
+// the bit masks so every sensor starts out printed and each one in turn is
+// shown on its own.
 //
 //*****************************************************************************
-int SensorTaskInit(void)
+static void SensorNextSelection(void)
+{
+    char pcRecord[LOG_RECORD_SIZE];
+    uint32_t i, ui32Mask = 0, ui32Used;
+
+    for(i = 0; i < NUM_SENSOR_DRIVERS; i++)
+    {
+        if(g_psSensors[i].bEnabled)
+        {
+            ui32Mask |= 1 << i;
+        }
+    }
+    ui32Mask--;
+    if(ui32Mask == 0)
+    {
+        ui32Mask = (1 << NUM_SENSOR_DRIVERS) - 1;
+    }
+
+    ui32Used = usnprintf(pcRecord, sizeof(pcRecord), "Printing");
+    for(i = 0; i < NUM_SENSOR_DRIVERS; i++)
+    {
+        g_psSensors[i].bEnabled = (ui32Mask & (1 << i)) != 0;
+        if(g_psSensors[i].bEnabled && (ui32Used < sizeof(pcRecord)))
+        {
+            ui32Used += usnprintf(pcRecord + ui32Used,
+                                  sizeof(pcRecord) - ui32Used, " %s",
+                                  g_psSensors[i].psDriver->pcName);
+        }
+    }
+    LogPrintf("%s\n", pcRecord);
+}
+
+//*****************************************************************************
+//
+// Finds the sensor named, or uniquely abbreviated, by pcName. Returns 0 if
+// there is none.
+//
+//*****************************************************************************
+static tSensorSchedule *SensorFind(const char *pcName)
+{
+    tSensorSchedule *psFound = 0;
+    uint32_t i, ui32Len;
+
+    ui32Len = ustrlen(pcName);
+    for(i = 0; i < NUM_SENSOR_DRIVERS; i++)
+    {
+        if(ustrncmp(pcName, g_psSensors[i].psDriver->pcName, ui32Len) == 0)
+        {
+            if(psFound != 0)
+            {
+                return(0);
+            }
+            psFound = &g_psSensors[i];
+        }
+    }
+    return(psFound);
+}
+
+//*****************************************************************************
+//
+// The console commands. Each runs on the Sensor task, between services, and
+// returns CONSOLE_OK or CONSOLE_BAD_ARGS.
+//
+//*****************************************************************************
+static int SensorCmdHelp(int argc, char *argv[]);
+
+// rate <sensor> <Hz>: changes how often a sensor is sampled and starts a new
+// rate report window, since the old one mixes both rates. The driver clamps
+// the rate to what the sensor can do, and the rate it settled on is shown.
+static int SensorCmdRate(int argc, char *argv[])
+{
+    tSensorSchedule *psSensor;
+    uint32_t ui32Hz, ui32CentiHz, i;
+    portTickType xNow;
+
+    if((argc != 3) || ((psSensor = SensorFind(argv[1])) == 0) ||
+       !ConsoleNumber(argv[2], &ui32Hz) || (ui32Hz == 0))
+    {
+        return(CONSOLE_BAD_ARGS);
+    }
+    psSensor->sSchedule.ui32PeriodUs =
+        psSensor->psDriver->pfnSetPeriod(1000000 / ui32Hz);
+
+    xNow = xTaskGetTickCount();
+    ScheduleRestart(&psSensor->sSchedule, xNow);
+    g_xRateStart = xNow;
+    for(i = 0; i < NUM_SENSOR_DRIVERS; i++)
+    {
+        g_psSensors[i].ui32Samples = 0;
+        g_psSensors[i].ui32Missed = 0;
+    }
+    ui32CentiHz = 100000000 / psSensor->sSchedule.ui32PeriodUs;
+    LogPrintf("%s: %d.%02d Hz\n", psSensor->psDriver->pcName,
+              ui32CentiHz / 100, ui32CentiHz % 100);
+    return(CONSOLE_OK);
+}
+
+// enable|disable <sensor>: prints or discards a sensor's samples, as the left
+// button does.
+static int SensorCmdEnable(int argc, char *argv[])
+{
+    tSensorSchedule *psSensor;
+
+    if((argc != 2) || ((psSensor = SensorFind(argv[1])) == 0))
+    {
+        return(CONSOLE_BAD_ARGS);
+    }
+    psSensor->bEnabled = (argv[0][0] == 'e');
+    return(CONSOLE_OK);
+}
+
+// output text|binary
+static int SensorCmdOutput(int argc, char *argv[])
+{
+    if((argc == 2) && (ustrncmp(argv[1], "text", 5) == 0))
+    {
+        SensorOutputBinary(false);
+    }
+    else if((argc == 2) && (ustrncmp(argv[1], "binary", 7) == 0))
+    {
+        SensorOutputBinary(true);
+    }
+    else
+    {
+        return(CONSOLE_BAD_ARGS);
+    }
+    return(CONSOLE_OK);
+}
+
+// stats: the right button's report, plus the bytes lost on the UART.
+static int SensorCmdStats(int argc, char *argv[])
+{
+    SensorRateReport();
+    LogPrintf("UART: %d tx dropped, %d rx dropped; %d buttons dropped\n",
+              UARTTxDropped(), UARTRxDropped(), SwitchesDropped());
+    return(CONSOLE_OK);
+}
+
+// tasks: where the CPU and the stacks have gone, and how full the queues
+// between the tasks are.
+static int SensorCmdTasks(int argc, char *argv[])
+{
+    RunTimeStatsReport();
+    LogPrintf("heap: %d of %d bytes free\n", xPortGetFreeHeapSize(),
+              configTOTAL_HEAP_SIZE);
+    LogPrintf("pool: %d of %d blocks in use, at most %d, %d refused\n",
+              PoolInUse(), POOL_BLOCK_COUNT, PoolHighWater(), PoolFailed());
+    LogPrintf("queues: sensor %d/%d, log %d/%d, blocks %d/%d\n",
+              uxQueueMessagesWaiting(g_pSensorQueue), SENSOR_QUEUE_SIZE,
+              LOG_QUEUE_SIZE - LogFree(), LOG_QUEUE_SIZE,
+              LOG_BLOCK_QUEUE_SIZE - LogBlockFree(), LOG_BLOCK_QUEUE_SIZE);
+    LogPrintf("uart: %d/%d\n", UART_TX_BUFFER_SIZE - UARTTxSpace(),
+              UART_TX_BUFFER_SIZE);
+    return(CONSOLE_OK);
+}
+
+// baud <rate>: the terminal has to follow.
+static int SensorCmdBaud(int argc, char *argv[])
+{
+    uint32_t ui32Baud;
+
+    if((argc != 2) || !ConsoleNumber(argv[1], &ui32Baud))
+    {
+        return(CONSOLE_BAD_ARGS);
+    }
+
+    // The logger owns UART0, and changes the rate once the log is out.
+    return(LogSetBaud(ui32Baud) ? CONSOLE_OK : CONSOLE_BAD_ARGS);
+}
+
+// bench <ms>: the sensors are not serviced while it runs.
+static int SensorCmdBench(int argc, char *argv[])
+{
+    uint32_t ui32Ms, i;
+    portTickType xNow;
+
+    if((argc != 2) || !ConsoleNumber(argv[1], &ui32Ms) || (ui32Ms == 0))
+    {
+        return(CONSOLE_BAD_ARGS);
+    }
+    SensorBenchmark(ui32Ms);
+
+    xNow = xTaskGetTickCount();
+    for(i = 0; i < NUM_SENSOR_DRIVERS; i++)
+    {
+        ScheduleRestart(&g_psSensors[i].sSchedule, xNow);
+    }
+    return(CONSOLE_OK);
+}
+
+static const tConsoleCommand g_psSensorCommands[] =
+{
+    { "help",    SensorCmdHelp,   "" },
+    { "rate",    SensorCmdRate,   "<sensor> <Hz>" },
+    { "enable",  SensorCmdEnable, "<sensor>" },
+    { "disable", SensorCmdEnable, "<sensor>" },
+    { "output",  SensorCmdOutput, "text|binary" },
+    { "stats",   SensorCmdStats,  "" },
+    { "tasks",   SensorCmdTasks,  "" },
+    { "baud",    SensorCmdBaud,   "<rate>" },
+    { "bench",   SensorCmdBench,  "<ms>" },
+};
+
+#define NUM_SENSOR_COMMANDS                                                   \
+    (sizeof(g_psSensorCommands) / sizeof(g_psSensorCommands[0]))
+
+static int SensorCmdHelp(int argc, char *argv[])
+{
+    uint32_t i;
+
+    for(i = 0; i < NUM_SENSOR_COMMANDS; i++)
+    {
+        LogPrintf("%s %s\n", g_psSensorCommands[i].pcCmd,
+                  g_psSensorCommands[i].pcHelp);
+    }
+    return(CONSOLE_OK);
+}
+
+//*****************************************************************************
+//
+// Feeds the received bytes to the console, echoing them, and reports any
+// command that failed. A CR/LF pair ends only one line. The echo is queued
+// to the logger like any other text, so it never lands inside a telemetry
+// frame; it is sent at each line end, ahead of the command's own output.
+//
+//*****************************************************************************
+static void SensorConsole(void)
+{
+    static char cLast;
+    char pcEcho[LOG_RECORD_SIZE];
+    uint32_t ui32Echo;
+    char cChar;
+    int iResult;
+
+    ui32Echo = 0;
+    while(UARTRxGet(&cChar))
+    {
+        if((cChar == '\n') && (cLast == '\r'))
+        {
+            cLast = cChar;
+            continue;
+        }
+        cLast = cChar;
+
+        //
+        // Make room for the longest echo, a backspace, if the record is
+        // full.
+        //
+        if(ui32Echo > (sizeof(pcEcho) - 3))
+        {
+            LogWrite(pcEcho, ui32Echo);
+            ui32Echo = 0;
+        }
+
+        if((cChar == '\r') || (cChar == '\n'))
+        {
+            pcEcho[ui32Echo++] = '\n';
+            LogWrite(pcEcho, ui32Echo);
+            ui32Echo = 0;
+        }
+        else if((cChar == '\b') || (cChar == 0x7F))
+        {
+            pcEcho[ui32Echo++] = '\b';
+            pcEcho[ui32Echo++] = ' ';
+            pcEcho[ui32Echo++] = '\b';
+        }
+        else
+        {
+            pcEcho[ui32Echo++] = cChar;
+        }
+
+        iResult = ConsoleFeed(&g_sConsole, cChar);
+        if(iResult == CONSOLE_BAD_CMD)
+        {
+            LogPrintf("Unknown command; try help\n");
+        }
+        else if(iResult == CONSOLE_BAD_ARGS)
+        {
+            LogPrintf("Bad arguments\n");
+        }
+        else if((iResult == CONSOLE_TOO_MANY_ARGS) ||
+                (iResult == CONSOLE_TOO_LONG))
+        {
+            LogPrintf("Line too long\n");
+        }
+    }
+
+    if(ui32Echo)
+    {
+        LogWrite(pcEcho, ui32Echo);
+    }
+}
+
+//*****************************************************************************
+//
+// This task samples every registered sensor concurrently, each on its own
+// schedule. The left button cycles which sensors are printed, and holding
+// it switches between text and binary output. The right button reports the
+// CPU load and the rate each sensor achieved, and holding it reports the
+// tasks. Lines typed on UART0 are run as commands (type help for the list).
+//
+// It only runs when there is something to do: a button command, a driver
+// event, a command line, or a deadline. Otherwise it stays blocked on its queue so the CPU
+// is free for the other tasks and idle.
+//
+//*****************************************************************************
+static void SensorTask(void *pvParameters)
 {
-    // Initialize the accelerometer and light sensor.
-    BSP_Accelerometer_Init();
-    BSP_LightSensor_Init();
+    const tSensorDriver *psDriver;
+    portTickType xNow;
+    uint8_t i8Message;
+    uint32_t i;
 
-    // Start reading from the accelerometer
-    SensorIndx = 0;
-    sensors[SensorIndx] = true;
+    // Everything the kernel allocates exists by now, so this is all the
+    // heap that will ever be used.
+    LogPrintf("heap: %d of %d bytes free\n", xPortGetFreeHeapSize(),
+              configTOTAL_HEAP_SIZE);
 
-    // Print the reading
-    UARTprintf("Reading from the accelerometer.");
+    // Measure the output paths before the real samples compete with them.
+    if(SENSOR_BENCHMARK_MS != 0)
+    {
+        SensorBenchmark(SENSOR_BENCHMARK_MS);
+    }
 
-    // Get a sensor reading
-    uint16_t x,y,z;
-    BSP_Accelerometer_Input(&x, &y, &z);
+    // Start every schedule now.
+    xNow = xTaskGetTickCount();
+    g_xRateStart = xNow;
+    for(i = 0; i < NUM_SENSOR_DRIVERS; i++)
+    {
+        ScheduleRestart(&g_psSensors[i].sSchedule, xNow);
+    }
 
-    // Guard UART from concurrent access.
-    xSemaphoreTake(g_pUARTSemaphore, portMAX_DELAY);
+    // Loop forever.
+    while(1)
+    {
+        // Wait for the next message, or until the earliest deadline.
+        if(xQueueReceive(g_pSensorQueue, &i8Message,
+                         SensorNextTimeout(xTaskGetTickCount())) == pdPASS)
+        {
+            // If left button pressed briefly, switch to the next set of
+            // printed sensors
+            if(i8Message == LEFT_BUTTON)
+            {
+                LOG0(LOG_LEFT_BUTTON);
+                SensorNextSelection();
+            }
+
+            // If right button pressed briefly, report load and achieved
+            // rates
+            else if(i8Message == RIGHT_BUTTON)
+            {
+                LOG0(LOG_RIGHT_BUTTON);
+                SensorRateReport();
+            }
+
+            // If left button held, switch between text and binary
+            else if(i8Message == (LEFT_BUTTON | SWITCH_LONG_PRESS))
+            {
+                LOG0(LOG_LEFT_LONG);
+                SensorOutputBinary(!g_bSensorBinary);
+            }
+
+            // If right button held, report the tasks
+            else if(i8Message == (RIGHT_BUTTON | SWITCH_LONG_PRESS))
+            {
+                LOG0(LOG_RIGHT_LONG);
+                RunTimeStatsReport();
+            }
+
+            // A hardware-paced sensor has filled a block; the rings are
+            // drained below.
+
+            // A command line has come in on the UART.
+            else if(i8Message == SENSOR_EVENT_CONSOLE)
+            {
+                SensorConsole();
+            }
+        }
+
+        // Service the blocks the drivers have filled, then every sensor
+        // whose deadline has passed.
+        xNow = xTaskGetTickCount();
+        for(i = 0; i < NUM_SENSOR_DRIVERS; i++)
+        {
+            SensorDrain(&g_psSensors[i], xNow);
+            // A software-paced sensor is read now; a hardware-paced one's
+            // block is late.
+            psDriver = g_psSensors[i].psDriver;
+            if(ScheduleWait(&g_psSensors[i].sSchedule, xNow) <= 0)
+            {
+                SensorService(&g_psSensors[i], psDriver->bHardwarePaced ?
+                              0 : psDriver->pfnRead(), xNow);
+            }
+        }
+    }
+}
 
-    // Print the reading
-    UARTprintf("[x,y,z] = [%d, %d, %d]\n", x,y,z);
+//*****************************************************************************
+//
+// Initializes the Sensor task.
+//
+//*****************************************************************************
+int SensorTaskInit(void)
+{
+    uint32_t i;
 
-    // Create a queue for sending messages to the sensor task.
+    // Create a queue for sending messages to the sensor task. The drivers
+    // post to it from their interrupts, so it must exist before they start.
     g_pSensorQueue = xQueueCreate(SENSOR_QUEUE_SIZE, SENSOR_ITEM_SIZE);
+    if(g_pSensorQueue == NULL)
+    {
+        return(1);
+    }
+
+    // Initialize every registered sensor, then start them all.
+    for(i = 0; i < NUM_SENSOR_DRIVERS; i++)
+    {
+        g_psSensors[i].psDriver = &g_psSensorDrivers[i];
+        g_psSensors[i].bEnabled = true;
+        ScheduleInit(&g_psSensors[i].sSchedule,
+                     g_psSensorDrivers[i].ui32PeriodUs,
+                     g_psSensorDrivers[i].ui32Batch,
+                     g_psSensorDrivers[i].bHardwarePaced,
+                     1000 * portTICK_RATE_MS);
+        RingInit(&g_psSensors[i].sBlocks, g_psSensors[i].ppsBlocks,
+                 sizeof(tSampleBlock *), SENSOR_RING_SIZE);
+        g_psSensorDrivers[i].pfnInit(SensorBlockFromISR);
+        LogPrintf("Sensor: %s\n", g_psSensorDrivers[i].pcName);
+    }
+    for(i = 0; i < NUM_SENSOR_DRIVERS; i++)
+    {
+        g_psSensorDrivers[i].pfnStart();
+    }
+
+    // Take commands from UART0.
+    ConsoleInit(&g_sConsole, g_psSensorCommands, NUM_SENSOR_COMMANDS);
+    UARTRxInit(SensorConsoleFromISR);
 
     // Create the sensor task.
-    if(xTaskCreate(SensorTask, (const portCHAR *)"Sensor", SENSORTASKSTACKSIZE, NULL,
-                   tskIDLE_PRIORITY + PRIORITY_SENSOR_TASK, NULL) != pdTRUE)
+    if(xTaskGenericCreate(SensorTask, (const signed char *)"Sensor",
+                          SENSORTASKSTACKSIZE, NULL,
+                          tskIDLE_PRIORITY + PRIORITY_SENSOR_TASK, NULL,
+                          g_pui32SensorTaskStack, NULL) != pdTRUE)
     {
         return(1);
     }
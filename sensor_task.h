@@ -1,7 +1,17 @@
 #ifndef __SENSOR_TASK_H__
 #define __SENSOR_TASK_H__
 
-// Prototype for the Sensor Task
+#include <stdbool.h>
+#include <stdint.h>
+
+// Driver events posted to the Sensor task's queue from interrupt handlers.
+// They share the queue with the button events (see switches.h).
+#define SENSOR_EVENT_BLOCK         0x80    // a sensor's block ring has data
+#define SENSOR_EVENT_CONSOLE       0x81    // a command line has been received
+
+// Prototypes for the Sensor Task
 extern int SensorTaskInit(void);
+extern void SensorOutputBinary(bool bBinary);
+extern void SensorBenchmark(uint32_t ui32Ms);
 
 #endif
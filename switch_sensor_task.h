@@ -1,7 +0,0 @@
-#ifndef __SWITCH_SENSOR_TASK_H__
-#define __SWITCH_SENSOR_TASK_H__
-
-// Prototype for the switch sensor task.
-extern uint32_t SwitchSensorTaskInit(void);
-
-#endif /* SWITCH_SENSOR_TASK_H_ */
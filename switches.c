@@ -0,0 +1,203 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_gpio.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "drivers/buttons.h"
+#include "priorities.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "switches.h"
+
+extern xQueueHandle g_pSensorQueue;
+
+//*****************************************************************************
+//
+// The buttons, in the order their hold times are kept.
+//
+//*****************************************************************************
+static const uint8_t g_pui8Switches[] = { LEFT_BUTTON, RIGHT_BUTTON };
+#define NUM_SWITCHES               sizeof(g_pui8Switches)
+
+//*****************************************************************************
+//
+// Debounce state, owned by the interrupt handlers. A bit is set while that
+// button is pressed. Hold times are counted in debounce periods, up to the
+// long press.
+//
+//*****************************************************************************
+static uint8_t g_ui8SwitchesState;          // settled state
+static uint8_t g_ui8SwitchesSample;         // state at the previous sample
+static uint32_t g_pui32SwitchesHeld[NUM_SWITCHES];
+
+//
+// Events lost because the Sensor task's queue was full.
+//
+static volatile uint32_t g_ui32SwitchesDropped;
+
+//*****************************************************************************
+//
+// Returns the buttons now down. They pull the pins low.
+//
+//*****************************************************************************
+static uint8_t
+SwitchesRead(void)
+{
+    return(~ROM_GPIOPinRead(GPIO_PORTF_BASE, ALL_BUTTONS) & ALL_BUTTONS);
+}
+
+//*****************************************************************************
+//
+// Sends an event to the Sensor task from an interrupt handler.
+//
+//*****************************************************************************
+static void
+SwitchesPost(uint8_t ui8Event, portBASE_TYPE *pxHigherPriorityTaskWoken)
+{
+    if(xQueueSendToBackFromISR(g_pSensorQueue, &ui8Event,
+                               pxHigherPriorityTaskWoken) != pdPASS)
+    {
+        g_ui32SwitchesDropped++;
+    }
+}
+
+//*****************************************************************************
+//
+// Port F interrupt handler. The first edge of a press or release turns the
+// edge interrupts off, so the bounces that follow cost nothing, and starts
+// the debounce timer.
+//
+//*****************************************************************************
+void
+SwitchesIntHandler(void)
+{
+    GPIOIntDisable(GPIO_PORTF_BASE, ALL_BUTTONS);
+    GPIOIntClear(GPIO_PORTF_BASE, ALL_BUTTONS);
+    g_ui8SwitchesSample = SwitchesRead();
+    ROM_TimerEnable(TIMER1_BASE, TIMER_A);
+}
+
+//*****************************************************************************
+//
+// Timer 1A interrupt handler, every SWITCH_DEBOUNCE_MS while a button is
+// down or bouncing. A button has settled when two samples in a row agree.
+// Once both are up and settled the timer stops and the edge interrupts take
+// over again. Edges latched meanwhile are left pending, so a press that
+// starts just now is not missed; at worst it costs one extra sample.
+//
+//*****************************************************************************
+void
+SwitchesTimerIntHandler(void)
+{
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+    uint8_t ui8Sample, ui8Changed, ui8Button;
+    uint32_t i;
+
+    ROM_TimerIntClear(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+
+    ui8Sample = SwitchesRead();
+    ui8Changed = (ui8Sample ^ g_ui8SwitchesState) &
+                 ~(ui8Sample ^ g_ui8SwitchesSample);
+    g_ui8SwitchesSample = ui8Sample;
+    g_ui8SwitchesState ^= ui8Changed;
+
+    for(i = 0; i < NUM_SWITCHES; i++)
+    {
+        ui8Button = g_pui8Switches[i];
+        if(ui8Changed & ui8Button)
+        {
+            //
+            // Nothing is sent for the press itself; whether it was short or
+            // long is only known once it is let go or has been held.
+            //
+            if(g_ui8SwitchesState & ui8Button)
+            {
+                g_pui32SwitchesHeld[i] = 0;
+            }
+            else
+            {
+                SwitchesPost((g_pui32SwitchesHeld[i] <
+                              (SWITCH_LONG_PRESS_MS / SWITCH_DEBOUNCE_MS)) ?
+                             ui8Button : (ui8Button | SWITCH_RELEASE),
+                             &xHigherPriorityTaskWoken);
+            }
+        }
+        else if((g_ui8SwitchesState & ui8Button) &&
+                (g_pui32SwitchesHeld[i] <
+                 (SWITCH_LONG_PRESS_MS / SWITCH_DEBOUNCE_MS)) &&
+                (++g_pui32SwitchesHeld[i] ==
+                 (SWITCH_LONG_PRESS_MS / SWITCH_DEBOUNCE_MS)))
+        {
+            SwitchesPost(ui8Button | SWITCH_LONG_PRESS,
+                         &xHigherPriorityTaskWoken);
+        }
+    }
+
+    if((ui8Sample == 0) && (g_ui8SwitchesState == 0))
+    {
+        ROM_TimerDisable(TIMER1_BASE, TIMER_A);
+        GPIOIntEnable(GPIO_PORTF_BASE, ALL_BUTTONS);
+    }
+
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+//*****************************************************************************
+//
+// Returns the number of button events lost because the Sensor task's queue
+// was full.
+//
+//*****************************************************************************
+uint32_t
+SwitchesDropped(void)
+{
+    return(g_ui32SwitchesDropped);
+}
+
+//*****************************************************************************
+//
+// Sets up the buttons to interrupt on both edges, and Timer 1A to debounce
+// them.
+//
+//*****************************************************************************
+void
+SwitchesInit(void)
+{
+    //
+    // Unlock the GPIO LOCK register for Right button to work.
+    //
+    HWREG(GPIO_PORTF_BASE + GPIO_O_LOCK) = GPIO_LOCK_KEY;
+    HWREG(GPIO_PORTF_BASE + GPIO_O_CR) = 0xFF;
+
+    //
+    // Initialize the buttons
+    //
+    ButtonsInit();
+
+    //
+    // Timer 1A runs periodically, but only while a button needs watching.
+    //
+    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    ROM_TimerConfigure(TIMER1_BASE, TIMER_CFG_PERIODIC);
+    ROM_TimerLoadSet(TIMER1_BASE, TIMER_A,
+                     (ROM_SysCtlClockGet() / 1000) * SWITCH_DEBOUNCE_MS);
+    ROM_TimerIntEnable(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
+    ROM_IntPrioritySet(INT_TIMER1A, PRIORITY_BUTTON_INT << 5);
+    ROM_IntEnable(INT_TIMER1A);
+
+    //
+    // Both edges of both buttons start the debounce timer.
+    //
+    ROM_GPIOIntTypeSet(GPIO_PORTF_BASE, ALL_BUTTONS, GPIO_BOTH_EDGES);
+    GPIOIntClear(GPIO_PORTF_BASE, ALL_BUTTONS);
+    GPIOIntEnable(GPIO_PORTF_BASE, ALL_BUTTONS);
+    ROM_IntPrioritySet(INT_GPIOF, PRIORITY_BUTTON_INT << 5);
+    ROM_IntEnable(INT_GPIOF);
+}
@@ -0,0 +1,28 @@
+#ifndef __SWITCHES_H__
+#define __SWITCHES_H__
+
+//*****************************************************************************
+//
+// Interrupt-driven buttons. An edge on either button starts a debounce
+// timer; once a button has settled its event goes straight into the Sensor
+// task's queue. A press is either short or long, never both: a short press
+// is sent as the button (LEFT_BUTTON or RIGHT_BUTTON) when it is let go,
+// and a long one as the button or'ed with SWITCH_LONG_PRESS as soon as it
+// has been held long enough, followed by SWITCH_RELEASE when it is let go.
+//
+//*****************************************************************************
+#define SWITCH_RELEASE             0x20    // let go after a long press
+#define SWITCH_LONG_PRESS          0x40    // held for SWITCH_LONG_PRESS_MS
+
+// How long a button must be stable, and held, for each event.
+#define SWITCH_DEBOUNCE_MS         10
+#define SWITCH_LONG_PRESS_MS       1000
+
+// Prototypes for the buttons. SwitchesInit() must be called after the
+// Sensor task's queue has been created.
+extern void SwitchesInit(void);
+extern uint32_t SwitchesDropped(void);
+extern void SwitchesIntHandler(void);
+extern void SwitchesTimerIntHandler(void);
+
+#endif // __SWITCHES_H__
@@ -0,0 +1,213 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "telemetry.h"
+
+//*****************************************************************************
+//
+// CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF), four bits
+// at a time.
+//
+//*****************************************************************************
+static const uint16_t g_pui16CRCTable[16] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t
+TelemetryCRC16(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+    uint16_t ui16CRC = 0xFFFF;
+
+    while(ui32Len--)
+    {
+        ui16CRC = (ui16CRC << 4) ^
+                  g_pui16CRCTable[(ui16CRC >> 12) ^ (*pui8Data >> 4)];
+        ui16CRC = (ui16CRC << 4) ^
+                  g_pui16CRCTable[(ui16CRC >> 12) ^ (*pui8Data & 0x0F)];
+        pui8Data++;
+    }
+    return(ui16CRC);
+}
+
+//*****************************************************************************
+//
+// Consistent overhead byte stuffing. Encodes ui32Len bytes into pui8Dst,
+// which needs room for ui32Len + ui32Len / 254 + 1 bytes, and returns the
+// encoded length. No delimiter is added.
+//
+//*****************************************************************************
+uint32_t
+TelemetryCOBSEncode(uint8_t *pui8Dst, const uint8_t *pui8Src,
+                    uint32_t ui32Len)
+{
+    uint32_t ui32Code = 0, ui32Out = 1;
+    uint8_t ui8Run = 1;
+
+    while(ui32Len--)
+    {
+        if(*pui8Src != 0)
+        {
+            pui8Dst[ui32Out++] = *pui8Src;
+            ui8Run++;
+        }
+        if((*pui8Src == 0) || (ui8Run == 0xFF))
+        {
+            pui8Dst[ui32Code] = ui8Run;
+            ui32Code = ui32Out++;
+            ui8Run = 1;
+        }
+        pui8Src++;
+    }
+    pui8Dst[ui32Code] = ui8Run;
+    return(ui32Out);
+}
+
+//*****************************************************************************
+//
+// Decodes one COBS block, without its delimiter, into pui8Dst, which needs
+// room for ui32Len bytes. Returns the decoded length, or -1 if the block is
+// malformed.
+//
+//*****************************************************************************
+int32_t
+TelemetryCOBSDecode(uint8_t *pui8Dst, const uint8_t *pui8Src,
+                    uint32_t ui32Len)
+{
+    uint32_t ui32In = 0, ui32Out = 0, ui32Code, i;
+
+    while(ui32In < ui32Len)
+    {
+        ui32Code = pui8Src[ui32In++];
+        if((ui32Code == 0) || ((ui32In + ui32Code - 1) > ui32Len))
+        {
+            return(-1);
+        }
+        for(i = 1; i < ui32Code; i++)
+        {
+            pui8Dst[ui32Out++] = pui8Src[ui32In++];
+        }
+        if((ui32Code != 0xFF) && (ui32In != ui32Len))
+        {
+            pui8Dst[ui32Out++] = 0;
+        }
+    }
+    return(ui32Out);
+}
+
+//*****************************************************************************
+//
+// Builds a complete, framed record in pui8Frame, which holds ui32Size bytes.
+// Returns the frame length, or 0 if it does not fit.
+//
+//*****************************************************************************
+uint32_t
+TelemetryFrame(uint8_t *pui8Frame, uint32_t ui32Size, uint8_t ui8Type,
+               uint8_t ui8Sequence, uint32_t ui32TimeMs, uint32_t ui32PeriodMs,
+               const void *pvSamples, uint32_t ui32Count,
+               uint32_t ui32SampleSize)
+{
+    uint8_t pui8Record[TELEMETRY_MAX_RECORD];
+    const uint8_t *pui8Samples = pvSamples;
+    uint32_t ui32Len, i;
+    uint16_t ui16CRC;
+
+    ui32Len = ui32Count * ui32SampleSize;
+    if((ui32Count > 0xFF) || (ui32SampleSize > 0xFF) ||
+       ((TELEMETRY_HEADER_SIZE + ui32Len + TELEMETRY_CRC_SIZE) >
+        sizeof(pui8Record)) ||
+       (TELEMETRY_FRAME_SIZE(ui32Len) > ui32Size))
+    {
+        return(0);
+    }
+
+    pui8Record[0] = ui8Type;
+    pui8Record[1] = ui8Sequence;
+    pui8Record[2] = ui32Count;
+    pui8Record[3] = ui32SampleSize;
+    pui8Record[4] = ui32PeriodMs;
+    pui8Record[5] = ui32PeriodMs >> 8;
+    pui8Record[6] = ui32TimeMs;
+    pui8Record[7] = ui32TimeMs >> 8;
+    pui8Record[8] = ui32TimeMs >> 16;
+    pui8Record[9] = ui32TimeMs >> 24;
+
+    //
+    // The samples are copied as they lie in memory, which is little-endian
+    // on the target.
+    //
+    for(i = 0; i < ui32Len; i++)
+    {
+        pui8Record[TELEMETRY_HEADER_SIZE + i] = pui8Samples[i];
+    }
+    ui32Len += TELEMETRY_HEADER_SIZE;
+    ui16CRC = TelemetryCRC16(pui8Record, ui32Len);
+    pui8Record[ui32Len++] = ui16CRC;
+    pui8Record[ui32Len++] = ui16CRC >> 8;
+
+    pui8Frame[0] = 0;
+    ui32Len = TelemetryCOBSEncode(pui8Frame + 1, pui8Record, ui32Len) + 1;
+    pui8Frame[ui32Len++] = 0;
+    return(ui32Len);
+}
+
+//*****************************************************************************
+//
+// Writes ui32Value as a varint and returns its length.
+//
+//*****************************************************************************
+static uint32_t
+TelemetryVarint(uint8_t *pui8Dst, uint32_t ui32Value)
+{
+    uint32_t ui32Len = 0;
+
+    while(ui32Value > 0x7F)
+    {
+        pui8Dst[ui32Len++] = (ui32Value & 0x7F) | 0x80;
+        ui32Value >>= 7;
+    }
+    pui8Dst[ui32Len++] = ui32Value;
+    return(ui32Len);
+}
+
+//*****************************************************************************
+//
+// Builds a complete, framed log record in pui8Frame, which holds ui32Size
+// bytes. Returns the frame length, or 0 if it does not fit.
+//
+//*****************************************************************************
+uint32_t
+TelemetryLogFrame(uint8_t *pui8Frame, uint32_t ui32Size, uint32_t ui32Format,
+                  const uint32_t *pui32Args, uint32_t ui32Count)
+{
+    uint8_t pui8Record[TELEMETRY_MAX_RECORD];
+    uint32_t ui32Len, i;
+    uint16_t ui16CRC;
+
+    //
+    // The worst case: a type byte, six varints of five bytes, and the CRC.
+    //
+    if(ui32Count > ((TELEMETRY_MAX_RECORD - 1 - TELEMETRY_CRC_SIZE) / 5) - 1)
+    {
+        return(0);
+    }
+
+    pui8Record[0] = TELEMETRY_TYPE_LOG;
+    ui32Len = 1 + TelemetryVarint(pui8Record + 1, ui32Format);
+    for(i = 0; i < ui32Count; i++)
+    {
+        ui32Len += TelemetryVarint(pui8Record + ui32Len, pui32Args[i]);
+    }
+    ui16CRC = TelemetryCRC16(pui8Record, ui32Len);
+    pui8Record[ui32Len++] = ui16CRC;
+    pui8Record[ui32Len++] = ui16CRC >> 8;
+
+    if((ui32Len + (ui32Len / 254) + 1 + 2) > ui32Size)
+    {
+        return(0);
+    }
+    pui8Frame[0] = 0;
+    ui32Len = TelemetryCOBSEncode(pui8Frame + 1, pui8Record, ui32Len) + 1;
+    pui8Frame[ui32Len++] = 0;
+    return(ui32Len);
+}
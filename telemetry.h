@@ -0,0 +1,76 @@
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+//*****************************************************************************
+//
+// Binary telemetry. Each batch of samples is sent as one record:
+//
+//   offset  size  field
+//   0       1     stream type (TELEMETRY_TYPE_*)
+//   1       1     sequence number, per stream, wrapping at 256
+//   2       1     number of samples
+//   3       1     bytes per sample
+//   4       2     sample period in ms
+//   6       4     time of the last sample, in ms since start-up
+//   10      n     samples, oldest first
+//   10+n    2     CRC-16/CCITT-FALSE of bytes 0 to 9+n
+//
+// All fields are little-endian. An accelerometer sample is three raw 12-bit
+// ADC codes (x, y, z) in 16 bits each; a light sample is one 32-bit reading
+// in the units of BSP_LightSensor_Input().
+//
+// The record is COBS encoded, so it contains no zero bytes, and sent with a
+// zero byte before and after it. A receiver resynchronizes at any zero, and
+// text that strays into the stream only costs the record it lands in.
+//
+// A log record (TELEMETRY_TYPE_LOG) is shorter, since it replaces a line
+// of text:
+//
+//   offset  size  field
+//   0       1     TELEMETRY_TYPE_LOG
+//   1       1-3   format ID from log_formats.h, as a varint
+//   ...     1-5   each argument word, as a varint
+//   ...     2     CRC-16/CCITT-FALSE of everything before it
+//
+// A varint holds seven bits per byte, least significant first, with the
+// top bit set on every byte but the last. It is framed the same way.
+//
+// This file builds both into the firmware and into the host decoder in
+// tools/, so it must not depend on anything target specific.
+//
+//*****************************************************************************
+
+#define TELEMETRY_TYPE_ACCEL       1
+#define TELEMETRY_TYPE_LIGHT       2
+#define TELEMETRY_TYPE_LOG         3
+
+#define TELEMETRY_HEADER_SIZE      10
+#define TELEMETRY_CRC_SIZE         2
+
+// Largest record, before framing, that TelemetryFrame() builds. It holds a
+// whole sample block (see sample_block.h) and keeps the stack use of the
+// encoder small.
+#define TELEMETRY_MAX_RECORD       128
+
+// Bytes a record of n payload bytes needs once framed: one COBS code byte
+// per 254 bytes plus the two delimiters.
+#define TELEMETRY_FRAME_SIZE(n)                                              \
+        (TELEMETRY_HEADER_SIZE + (n) + TELEMETRY_CRC_SIZE +                  \
+         ((TELEMETRY_HEADER_SIZE + (n) + TELEMETRY_CRC_SIZE) / 254) + 1 + 2)
+
+extern uint16_t TelemetryCRC16(const uint8_t *pui8Data, uint32_t ui32Len);
+extern uint32_t TelemetryCOBSEncode(uint8_t *pui8Dst, const uint8_t *pui8Src,
+                                    uint32_t ui32Len);
+extern int32_t TelemetryCOBSDecode(uint8_t *pui8Dst, const uint8_t *pui8Src,
+                                   uint32_t ui32Len);
+extern uint32_t TelemetryFrame(uint8_t *pui8Frame, uint32_t ui32Size,
+                               uint8_t ui8Type, uint8_t ui8Sequence,
+                               uint32_t ui32TimeMs, uint32_t ui32PeriodMs,
+                               const void *pvSamples, uint32_t ui32Count,
+                               uint32_t ui32SampleSize);
+extern uint32_t TelemetryLogFrame(uint8_t *pui8Frame, uint32_t ui32Size,
+                                  uint32_t ui32Format,
+                                  const uint32_t *pui32Args,
+                                  uint32_t ui32Count);
+
+#endif // __TELEMETRY_H__
@@ -0,0 +1,413 @@
+//*****************************************************************************
+//
+// block_test.c - Host test of who frees the sample blocks.
+//
+// A sample block (sample_block.h) belongs to whoever holds its pointer,
+// which must pass it on or give it back to the pool, once. This builds the
+// Sensor task and the logger from sensor_task.c and log_task.c as they are,
+// against the stand-ins for the kernel and TivaWare in host/ and the
+// stubs below, and services blocks through them: printed as text, sent as
+// binary telemetry, sent with the logger's block queue full, not printed
+// at all, and refused by the interrupt handler. After each case every
+// block must be back in the pool, and only once: a block freed twice sits
+// in the pool's free list twice, so the pool is then emptied and the
+// blocks it hands out checked to be all different. The exit status is
+// non-zero if any check fails.
+//
+// Build and run on the host:
+//
+//   cc -std=gnu99 -Ihost -I.. -o block_test block_test.c ../atomic.c
+//      ../console.c ../pool.c ../ring.c ../schedule.c ../telemetry.c
+//   ./block_test
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "check.h"
+
+//
+// Built in, so that the test can call their static functions.
+//
+#include "log_task.c"
+#include "sensor_task.c"
+
+//*****************************************************************************
+//
+// The kernel. The test is the only thread, and time only moves when a task
+// would sleep.
+//
+//*****************************************************************************
+static portTickType g_xTestTicks;
+static uint8_t g_pui8TestQueue[1];
+
+signed portBASE_TYPE
+xTaskGenericCreate(pdTASK_CODE pxTaskCode, const signed char *pcName,
+                   unsigned short usStackDepth, void *pvParameters,
+                   unsigned portBASE_TYPE uxPriority,
+                   xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer,
+                   const xMemoryRegion *xRegions)
+{
+    return(pdTRUE);
+}
+
+portTickType
+xTaskGetTickCount(void)
+{
+    return(g_xTestTicks);
+}
+
+void
+vTaskDelay(portTickType xTicksToDelay)
+{
+    g_xTestTicks += xTicksToDelay;
+}
+
+xQueueHandle
+xQueueCreate(unsigned portBASE_TYPE uxQueueLength,
+             unsigned portBASE_TYPE uxItemSize)
+{
+    return(g_pui8TestQueue);
+}
+
+signed portBASE_TYPE
+xQueueReceive(xQueueHandle xQueue, void *pvBuffer, portTickType xTicksToWait)
+{
+    return(pdFALSE);
+}
+
+signed portBASE_TYPE
+xQueueSendToBackFromISR(xQueueHandle xQueue, const void *pvItemToQueue,
+                        signed portBASE_TYPE *pxHigherPriorityTaskWoken)
+{
+    return(pdPASS);
+}
+
+unsigned portBASE_TYPE
+uxQueueMessagesWaiting(xQueueHandle xQueue)
+{
+    return(0);
+}
+
+signed portBASE_TYPE
+xSemaphoreTake(xSemaphoreHandle xSemaphore, portTickType xBlockTime)
+{
+    return(pdFALSE);
+}
+
+signed portBASE_TYPE
+xSemaphoreGive(xSemaphoreHandle xSemaphore)
+{
+    return(pdTRUE);
+}
+
+size_t
+xPortGetFreeHeapSize(void)
+{
+    return(0);
+}
+
+//*****************************************************************************
+//
+// UART0, which takes everything at once, and the rest of the firmware the
+// Sensor task reports on.
+//
+//*****************************************************************************
+static uint32_t g_ui32TestBinaryWrites;
+
+uint32_t
+UARTTxWrite(const char *pcBuf, uint32_t ui32Len)
+{
+    return(ui32Len);
+}
+
+uint32_t
+UARTTxWriteBinary(const uint8_t *pui8Buf, uint32_t ui32Len)
+{
+    g_ui32TestBinaryWrites++;
+    return(ui32Len);
+}
+
+uint32_t
+UARTTxSpace(void)
+{
+    return(UART_TX_BUFFER_SIZE);
+}
+
+uint32_t
+UARTTxDropped(void)
+{
+    return(0);
+}
+
+bool
+UARTTxSetBaud(uint32_t ui32Baud)
+{
+    return(true);
+}
+
+uint32_t
+UARTTxBaud(void)
+{
+    return(115200);
+}
+
+void
+UARTRxInit(void (*pfnLine)(void))
+{
+}
+
+bool
+UARTRxGet(char *pcChar)
+{
+    return(false);
+}
+
+uint32_t
+UARTRxDropped(void)
+{
+    return(0);
+}
+
+uint32_t
+CPULoadGet(void)
+{
+    return(0);
+}
+
+void
+PowerReport(void)
+{
+}
+
+void
+RunTimeStatsReport(void)
+{
+}
+
+uint32_t
+SwitchesDropped(void)
+{
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Two sensors shaped like the real ones: a hardware-paced accelerometer
+// and a software-paced light sensor, which never have data of their own.
+//
+//*****************************************************************************
+#define TEST_SAMPLES               4
+
+static void
+TestInit(void (*pfnBlock)(tSampleBlock *psBlock))
+{
+}
+
+static void
+TestStart(void)
+{
+}
+
+static uint32_t
+TestSetPeriod(uint32_t ui32PeriodUs)
+{
+    return(ui32PeriodUs);
+}
+
+static tSampleBlock *
+TestRead(void)
+{
+    return(0);
+}
+
+static uint32_t
+TestAccelArgs(uint32_t *pui32Args, const void *pvBatch, uint32_t ui32Index)
+{
+    const uint16_t *pui16Sample = (const uint16_t *)pvBatch + (3 * ui32Index);
+
+    pui32Args[0] = pui16Sample[0];
+    pui32Args[1] = pui16Sample[1];
+    pui32Args[2] = pui16Sample[2];
+    return(3);
+}
+
+static uint32_t
+TestLightArgs(uint32_t *pui32Args, const void *pvBatch, uint32_t ui32Index)
+{
+    pui32Args[0] = ((const uint32_t *)pvBatch)[ui32Index];
+    return(1);
+}
+
+const tSensorDriver g_psSensorDrivers[NUM_SENSOR_DRIVERS] =
+{
+    { "accelerometer", 1000, TEST_SAMPLES, true,
+      TELEMETRY_TYPE_ACCEL, 3 * sizeof(uint16_t),
+      TestInit, TestStart, TestSetPeriod, 0, LOG_ACCEL_SAMPLE, TestAccelArgs },
+    { "light", 100000, 1, false,
+      TELEMETRY_TYPE_LIGHT, sizeof(uint32_t),
+      TestInit, TestStart, TestSetPeriod, TestRead, LOG_LIGHT_SAMPLE,
+      TestLightArgs },
+};
+
+//*****************************************************************************
+//
+// Takes a block from the pool and fills it as the accelerometer would.
+//
+//*****************************************************************************
+static tSampleBlock *
+TestBlock(uint8_t ui8Type)
+{
+    tSampleBlock *psBlock;
+    uint32_t i;
+
+    psBlock = SampleBlockAlloc();
+    if(psBlock != 0)
+    {
+        psBlock->ui8Type = ui8Type;
+        psBlock->ui8SampleSize = 3 * sizeof(uint16_t);
+        psBlock->ui8Count = TEST_SAMPLES;
+        for(i = 0; i < (3 * TEST_SAMPLES); i++)
+        {
+            ((uint16_t *)psBlock->pui32Data)[i] = 2048 + i;
+        }
+    }
+    return(psBlock);
+}
+
+//*****************************************************************************
+//
+// Services ui32Count new blocks of the accelerometer, as the Sensor task
+// does for the blocks its interrupt posts.
+//
+//*****************************************************************************
+static void
+TestService(uint32_t ui32Count)
+{
+    while(ui32Count--)
+    {
+        SensorService(&g_psSensors[0], TestBlock(TELEMETRY_TYPE_ACCEL),
+                      g_xTestTicks++);
+    }
+}
+
+//*****************************************************************************
+//
+// Checks that every block is back in the pool, each once: the pool hands
+// out POOL_BLOCK_COUNT different blocks, and then no more.
+//
+//*****************************************************************************
+static void
+TestPoolWhole(const char *pcWhat)
+{
+    void *ppvBlocks[POOL_BLOCK_COUNT + 1];
+    uint32_t ui32Count, i, j;
+    bool bDistinct = true;
+
+    CHECK(PoolInUse() == 0, pcWhat);
+
+    for(ui32Count = 0; ui32Count <= POOL_BLOCK_COUNT; ui32Count++)
+    {
+        ppvBlocks[ui32Count] = PoolAlloc();
+        if(ppvBlocks[ui32Count] == 0)
+        {
+            break;
+        }
+    }
+    for(i = 0; i < ui32Count; i++)
+    {
+        for(j = i + 1; j < ui32Count; j++)
+        {
+            bDistinct = bDistinct && (ppvBlocks[i] != ppvBlocks[j]);
+        }
+    }
+    CHECK((ui32Count == POOL_BLOCK_COUNT) && bDistinct, pcWhat);
+
+    for(i = 0; i < ui32Count; i++)
+    {
+        PoolFree(ppvBlocks[i]);
+    }
+}
+
+//*****************************************************************************
+//
+// Sends every block in the logger's queue, as the logger does.
+//
+//*****************************************************************************
+static uint32_t
+TestSendAll(void)
+{
+    uint32_t ui32Sent = 0;
+
+    while(LogSendBlock())
+    {
+        ui32Sent++;
+    }
+    return(ui32Sent);
+}
+
+int
+main(void)
+{
+    uint32_t ui32Dropped;
+
+    PoolInit();
+    CHECK(LogTaskInit() == 0, "logger started");
+    CHECK(SensorTaskInit() == 0, "Sensor task started");
+    TestPoolWhole("pool whole at the start");
+
+    //
+    // Text: the Sensor task prints each block and frees it at once.
+    //
+    SensorOutputBinary(false);
+    TestService(2 * POOL_BLOCK_COUNT);
+    TestPoolWhole("text: every block freed once");
+
+    //
+    // Binary: the logger holds each block until it has framed it.
+    //
+    SensorOutputBinary(true);
+    g_ui32TestBinaryWrites = 0;
+    TestService(LOG_BLOCK_QUEUE_SIZE / 2);
+    CHECK(PoolInUse() == (LOG_BLOCK_QUEUE_SIZE / 2),
+          "binary: blocks held until sent");
+    CHECK(TestSendAll() == (LOG_BLOCK_QUEUE_SIZE / 2),
+          "binary: every block sent");
+    CHECK(g_ui32TestBinaryWrites == (LOG_BLOCK_QUEUE_SIZE / 2),
+          "binary: one frame per block");
+    TestPoolWhole("binary: every block freed once");
+
+    //
+    // Binary with the logger's block queue full: the blocks that do not fit
+    // are freed at once and counted as dropped.
+    //
+    ui32Dropped = LogDropped();
+    TestService(LOG_BLOCK_QUEUE_SIZE + 3);
+    CHECK(LogDropped() == (ui32Dropped + 3), "queue full: drops counted");
+    CHECK(PoolInUse() == LOG_BLOCK_QUEUE_SIZE,
+          "queue full: the blocks that do not fit freed");
+    CHECK(TestSendAll() == LOG_BLOCK_QUEUE_SIZE,
+          "queue full: the queued blocks sent");
+    TestPoolWhole("queue full: every block freed once");
+
+    //
+    // Not printed: a disabled sensor's blocks are freed unseen, in either
+    // output.
+    //
+    g_psSensors[0].bEnabled = false;
+    TestService(POOL_BLOCK_COUNT);
+    SensorOutputBinary(false);
+    TestService(POOL_BLOCK_COUNT);
+    g_psSensors[0].bEnabled = true;
+    CHECK(TestSendAll() == 0, "disabled: nothing sent");
+    TestPoolWhole("disabled: every block freed once");
+
+    //
+    // A block of a type no sensor has is freed by the interrupt handler.
+    //
+    SensorBlockFromISR(TestBlock(TELEMETRY_TYPE_LOG));
+    TestPoolWhole("unknown sensor: the block freed once");
+
+    return(CHECK_SUMMARY());
+}
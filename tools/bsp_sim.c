@@ -0,0 +1,1493 @@
+//*****************************************************************************
+//
+// bsp_sim.c - Host model of the TM4C123 peripherals that inc/bsp.c drives.
+//
+// Compiled with BSP_HOST_SIM defined, inc/bsp.c reaches its registers
+// through SimRegister() (see inc/bsp_sim.h) instead of their addresses, so
+// the driver runs unchanged on a PC against this model:
+//
+// - ADC0 sample sequencer 2, triggered by PSSI or by Timer0A, with a
+//   four-entry FIFO and per-channel input codes set by SimSetAnalog();
+// - Timer0A in periodic mode, as the ADC trigger, with any access while
+//   its clock is off counted as the bus fault it would be on the part;
+// - uDMA channel 16 in basic and ping-pong modes, moving SS2 results from
+//   the FIFO into memory through the control table, with its completion
+//   interrupt on the SS2 vector;
+// - the I2C1 master, with transfers that take the bus time set by MTPR,
+//   and an OPT3001 at address 0x44 on the bus;
+// - GPIO Port A edge interrupts, with PA5 driven by the OPT3001 INT pin;
+// - the NVIC enables for IRQs 0, 16 and 37, whose handlers are called when
+//   enabled, pending and not masked by PRIMASK.
+//
+// Run without arguments, it checks the polled, interrupt-driven and
+// timer-paced accelerometer drivers, the I2C transaction engine and the
+// light sensor against the model and exits non-zero if any check fails.
+// With -b it runs the BSP benchmark (bench.h), timed by a model of the DWT
+// cycle counter in simulated cycles.
+//
+// Build and run on the host:
+//
+//   cc -std=gnu99 -DBSP_HOST_SIM -DBENCH_MODE=1 -I.. -o bsp_sim
+//      bsp_sim.c ../inc/bsp.c ../bench.c
+//   ./bsp_sim && ./bsp_sim -b
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "inc/bsp_sim.h"
+#include "inc/bsp.h"
+#include "bench.h"
+#include "check.h"
+
+//*****************************************************************************
+//
+// The registers the model gives a meaning to. bsp_sim.h has turned the
+// usual names into SimRegister() calls, so the model uses addresses.
+//
+//*****************************************************************************
+#define SIM_ADC0_ACTSS             0x40038000
+#define SIM_ADC0_RIS               0x40038004
+#define SIM_ADC0_IM                0x40038008
+#define SIM_ADC0_ISC               0x4003800C
+#define SIM_ADC0_EMUX              0x40038014
+#define SIM_ADC0_PSSI              0x40038028
+#define SIM_ADC0_SSMUX2            0x40038080
+#define SIM_ADC0_SSCTL2            0x40038084
+#define SIM_ADC0_SSFIFO2           0x40038088
+#define SIM_GPIOA_DATA             0x40004000
+#define SIM_GPIOA_DATA_END         0x400043FC
+#define SIM_GPIOA_IS               0x40004404
+#define SIM_GPIOA_IBE              0x40004408
+#define SIM_GPIOA_IEV              0x4000440C
+#define SIM_GPIOA_IM               0x40004410
+#define SIM_GPIOA_RIS              0x40004414
+#define SIM_GPIOA_MIS              0x40004418
+#define SIM_GPIOA_ICR              0x4000441C
+#define SIM_I2C1_MSA               0x40021000
+#define SIM_I2C1_MCS               0x40021004
+#define SIM_I2C1_MDR               0x40021008
+#define SIM_I2C1_MTPR              0x4002100C
+#define SIM_I2C1_MIMR              0x40021010
+#define SIM_I2C1_MRIS              0x40021014
+#define SIM_I2C1_MMIS              0x40021018
+#define SIM_I2C1_MICR              0x4002101C
+#define SIM_TIMER0                 0x40030000
+#define SIM_TIMER0_END             0x40030FFF
+#define SIM_TIMER0_CTL             0x4003000C
+#define SIM_TIMER0_TAILR           0x40030028
+#define SIM_NVIC_EN0               0xE000E100
+#define SIM_NVIC_EN1               0xE000E104
+#define SIM_NVIC_DIS0              0xE000E180
+#define SIM_NVIC_DIS1              0xE000E184
+#define SIM_SYSCTL_RIS             0x400FE050
+#define SIM_SYSCTL_RCGCTIMER       0x400FE604
+#define SIM_SYSCTL_PR              0x400FEA00
+#define SIM_SYSCTL_PR_END          0x400FEA7C
+#define SIM_UDMA_CFG               0x400FF004
+#define SIM_UDMA_CTLBASE           0x400FF008
+#define SIM_UDMA_ENASET            0x400FF028
+#define SIM_UDMA_ENACLR            0x400FF02C
+#define SIM_UDMA_ALTSET            0x400FF030
+#define SIM_UDMA_ALTCLR            0x400FF034
+#define SIM_UDMA_CHIS              0x400FF504
+#define SIM_UDMA_CHMAP2            0x400FF518
+#define SIM_DEMCR                  0xE000EDFC
+#define SIM_DWT_CTRL               0xE0001000
+#define SIM_DWT_CYCCNT             0xE0001004
+
+//
+// The uDMA channel ADC0 SS2 requests with CHMAP2 encoding 0, and the
+// stand-in bus addresses for host memory: a window of SIM_DMA_WINDOW bytes
+// centred on each pointer handed over, so that addresses worked out back
+// from an end pointer map too.
+//
+#define SIM_DMA_ADC_CH             16
+#define SIM_DMA_SRAM               0x20000000
+#define SIM_DMA_WINDOW             0x10000
+#define SIM_DMA_MAPS               32
+
+//
+// Model timing. The ADC runs at 125 ksps (ADC0_PC_R = 1); an I2C bit is
+// 20 * (MTPR + 1) bus clocks.
+//
+#define SIM_ADC_SAMPLE_CYCLES      (SIM_CLOCK_HZ / 125000)
+#define SIM_I2C_BIT_CYCLES         (20 * ((SimGet(SIM_I2C1_MTPR) & 0x7F) + 1))
+#define SIM_OPT_100MS_CYCLES       (SIM_CLOCK_HZ / 10)
+#define SIM_OPT_800MS_CYCLES       ((SIM_CLOCK_HZ / 10) * 8)
+#define SIM_NEVER                  UINT64_MAX
+
+//
+// The OPT3001 and its Configuration Register fields.
+//
+#define SIM_OPT_ADDRESS            0x44
+#define SIM_OPT_CT                 0x0800
+#define SIM_OPT_M_M                0x0600
+#define SIM_OPT_M_SHUTDOWN         0x0000
+#define SIM_OPT_M_SINGLE           0x0200
+#define SIM_OPT_READ_ONLY          0x01E0  // OVF, CRF, FH, FL
+#define SIM_OPT_CRF                0x0080
+#define SIM_OPT_FLAGS              0x00E0  // CRF, FH, FL
+#define SIM_OPT_L                  0x0010
+#define SIM_OPT_POL                0x0008
+#define SIM_OPT_INT_PIN            0x20    // PA5
+
+//*****************************************************************************
+//
+// The register file, a small open-addressed table of every register that
+// has been touched.
+//
+//*****************************************************************************
+#define SIM_NUM_REGS               1024
+
+typedef struct
+{
+    uint32_t ui32Addr;
+    bool bUsed;
+    volatile uint32_t ui32Value;
+}
+tSimReg;
+
+static tSimReg g_psSimRegs[SIM_NUM_REGS];
+
+//
+// The access in progress: the register handed out last and the value a
+// read of it saw. A different value at the next access means it was
+// written.
+//
+static tSimReg *g_psSimPending;
+static uint32_t g_ui32SimPendingValue;
+
+//
+// Time, PRIMASK and handler nesting.
+//
+static uint64_t g_ui64SimNow;
+static uint32_t g_ui32SimPrimask;
+static bool g_bSimInHandler;
+static uint32_t g_pui32SimNvicEnabled[2];
+
+//
+// ADC0 sequencer 2.
+//
+static uint16_t g_pui16SimAnalog[12];
+static uint16_t g_pui16SimFifo[4];
+static uint32_t g_ui32SimFifoCount;
+static uint32_t g_ui32SimFifoRead;
+static uint32_t g_ui32SimAdcRis;
+static uint64_t g_ui64SimAdcDone;
+
+//
+// Timer0A.
+//
+static uint64_t g_ui64SimTimerNext;
+
+//
+// uDMA: the channels enabled and those using their alternate control
+// structure, the raw completion status, and the host memory behind each
+// stand-in bus address.
+//
+static uint32_t g_ui32SimDmaEnabled;
+static uint32_t g_ui32SimDmaAlt;
+static uint32_t g_ui32SimDmaChis;
+static uint8_t *g_ppui8SimDmaMap[SIM_DMA_MAPS];
+static uint32_t g_ui32SimDmaMaps;
+
+//
+// Accesses that would bus fault on the part: Timer0 while its clock is off,
+// and uDMA transfers to addresses that map to nothing.
+//
+static uint32_t g_ui32SimBusFaults;
+
+//
+// I2C1 master: the status of the last command, whether the bus is held
+// between START and STOP, and when the transfer in flight ends.
+//
+static uint32_t g_ui32SimI2CError;
+static bool g_bSimI2CHeld;
+static bool g_bSimI2CAddressed;
+static uint32_t g_ui32SimI2CRis;
+static uint64_t g_ui64SimI2CDone;
+
+//
+// The OPT3001: Result, Configuration, Low Limit and High Limit, the
+// pointer register, the byte position in the current transfer, and the
+// next conversion.
+//
+static uint16_t g_pui16SimOpt[4];
+static uint8_t g_ui8SimOptPointer;
+static uint32_t g_ui32SimOptByte;
+static uint8_t g_ui8SimOptHigh;
+static bool g_bSimOptInt;
+static uint16_t g_ui16SimLight;
+static uint64_t g_ui64SimOptDone;
+
+//
+// GPIO Port A pins and raw interrupt status.
+//
+static uint8_t g_ui8SimPortA;
+static uint32_t g_ui32SimPortARis;
+
+//
+// The DWT cycle counter: CYCCNT reads as the simulated time plus this
+// offset while it is enabled.
+//
+static uint32_t g_ui32SimCycOffset;
+
+//*****************************************************************************
+//
+// Finds, or adds, the register at ui32Addr.
+//
+//*****************************************************************************
+static tSimReg *
+SimLookup(uint32_t ui32Addr)
+{
+    uint32_t i;
+
+    i = (ui32Addr >> 2) & (SIM_NUM_REGS - 1);
+    while(g_psSimRegs[i].bUsed && (g_psSimRegs[i].ui32Addr != ui32Addr))
+    {
+        i = (i + 1) & (SIM_NUM_REGS - 1);
+    }
+    if(!g_psSimRegs[i].bUsed)
+    {
+        g_psSimRegs[i].bUsed = true;
+        g_psSimRegs[i].ui32Addr = ui32Addr;
+        g_psSimRegs[i].ui32Value = 0;
+    }
+    return(&g_psSimRegs[i]);
+}
+
+//
+// The stored value of a plain configuration register.
+//
+static uint32_t
+SimGet(uint32_t ui32Addr)
+{
+    return(SimLookup(ui32Addr)->ui32Value);
+}
+
+//*****************************************************************************
+//
+// GPIO Port A. Edge-sensitive interrupts only, which is all bsp.c uses.
+//
+//*****************************************************************************
+static void
+SimPortASet(uint8_t ui8Pins)
+{
+    uint8_t ui8Changed, ui8Rising, ui8Edge;
+
+    ui8Changed = g_ui8SimPortA ^ ui8Pins;
+    ui8Rising = ui8Changed & ui8Pins;
+    ui8Edge = ~SimGet(SIM_GPIOA_IS) &
+              ((SimGet(SIM_GPIOA_IBE) & ui8Changed) |
+               (~SimGet(SIM_GPIOA_IBE) & SimGet(SIM_GPIOA_IEV) & ui8Rising) |
+               (~SimGet(SIM_GPIOA_IBE) & ~SimGet(SIM_GPIOA_IEV) &
+                ui8Changed & ~ui8Rising));
+    g_ui32SimPortARis |= ui8Edge;
+    g_ui8SimPortA = ui8Pins;
+}
+
+//*****************************************************************************
+//
+// The OPT3001. INT reports the end of each conversion when the two top bits
+// of the Low Limit Register are set, as bsp.c programs it, and stays
+// asserted until the Configuration Register is read.
+//
+//*****************************************************************************
+static void
+SimOptInt(bool bAsserted)
+{
+    bool bHigh;
+
+    g_bSimOptInt = bAsserted;
+    bHigh = bAsserted == ((g_pui16SimOpt[1] & SIM_OPT_POL) != 0);
+    SimPortASet(bHigh ? (g_ui8SimPortA | SIM_OPT_INT_PIN) :
+                        (g_ui8SimPortA & ~SIM_OPT_INT_PIN));
+}
+
+static void
+SimOptConvert(void)
+{
+    g_ui64SimOptDone = g_ui64SimNow +
+                       ((g_pui16SimOpt[1] & SIM_OPT_CT) ?
+                        SIM_OPT_800MS_CYCLES : SIM_OPT_100MS_CYCLES);
+}
+
+static void
+SimOptDone(void)
+{
+    g_pui16SimOpt[0] = g_ui16SimLight;
+    g_pui16SimOpt[1] |= SIM_OPT_CRF;
+    if((g_pui16SimOpt[1] & SIM_OPT_M_M) == SIM_OPT_M_SINGLE)
+    {
+        g_pui16SimOpt[1] &= ~SIM_OPT_M_M;
+        g_ui64SimOptDone = SIM_NEVER;
+    }
+    else
+    {
+        SimOptConvert();
+    }
+    if((g_pui16SimOpt[2] & 0xC000) == 0xC000)
+    {
+        SimOptInt(true);
+    }
+}
+
+static void
+SimOptWrite(uint8_t ui8Reg, uint16_t ui16Value)
+{
+    uint16_t ui16Old;
+
+    if(ui8Reg == 0x01)
+    {
+        ui16Old = g_pui16SimOpt[1];
+        g_pui16SimOpt[1] = (ui16Value & ~SIM_OPT_READ_ONLY) |
+                           (ui16Old & SIM_OPT_READ_ONLY);
+
+        //
+        // A single-shot write always starts a conversion; continuous mode
+        // only from shutdown.
+        //
+        if((ui16Value & SIM_OPT_M_M) == SIM_OPT_M_SHUTDOWN)
+        {
+            g_ui64SimOptDone = SIM_NEVER;
+        }
+        else if(((ui16Value & SIM_OPT_M_M) == SIM_OPT_M_SINGLE) ||
+                ((ui16Old & SIM_OPT_M_M) == SIM_OPT_M_SHUTDOWN))
+        {
+            SimOptConvert();
+        }
+        if((ui16Value & SIM_OPT_L) == 0)
+        {
+            SimOptInt(false);
+        }
+    }
+    else if((ui8Reg == 0x02) || (ui8Reg == 0x03))
+    {
+        g_pui16SimOpt[ui8Reg] = ui16Value;
+    }
+}
+
+static uint8_t
+SimOptReadByte(void)
+{
+    uint16_t ui16Value;
+    bool bLow;
+
+    switch(g_ui8SimOptPointer)
+    {
+        case 0x00:
+        case 0x01:
+        case 0x02:
+        case 0x03:
+            ui16Value = g_pui16SimOpt[g_ui8SimOptPointer];
+            break;
+        case 0x7E:
+            ui16Value = 0x5449;         // manufacturer ID
+            break;
+        case 0x7F:
+            ui16Value = 0x3001;         // device ID
+            break;
+        default:
+            ui16Value = 0xFFFF;
+            break;
+    }
+    bLow = (g_ui32SimOptByte++ & 1) != 0;
+
+    //
+    // Reading the Configuration Register clears its flags and releases INT.
+    //
+    if(bLow && (g_ui8SimOptPointer == 0x01))
+    {
+        g_pui16SimOpt[1] &= ~SIM_OPT_FLAGS;
+        SimOptInt(false);
+    }
+    return(bLow ? (ui16Value & 0xFF) : (ui16Value >> 8));
+}
+
+static void
+SimOptWriteByte(uint8_t ui8Byte)
+{
+    if(g_ui32SimOptByte == 0)
+    {
+        g_ui8SimOptPointer = ui8Byte;
+    }
+    else if(g_ui32SimOptByte == 1)
+    {
+        g_ui8SimOptHigh = ui8Byte;
+    }
+    else if(g_ui32SimOptByte == 2)
+    {
+        SimOptWrite(g_ui8SimOptPointer, (g_ui8SimOptHigh << 8) | ui8Byte);
+    }
+    g_ui32SimOptByte++;
+}
+
+//*****************************************************************************
+//
+// I2C1 master. A command moves one byte, with START and STOP as asked, and
+// ends MRIS-flagged after the bits it puts on the bus.
+//
+//*****************************************************************************
+static void
+SimI2CCommand(uint32_t ui32Command)
+{
+    uint32_t ui32Bits = 0, ui32MSA;
+
+    ui32MSA = SimGet(SIM_I2C1_MSA);
+    g_ui32SimI2CError = 0;
+    if(ui32Command & I2C_MCS_RUN)
+    {
+        if(ui32Command & I2C_MCS_START)
+        {
+            //
+            // START or repeated START, then the address byte.
+            //
+            ui32Bits += 10;
+            g_bSimI2CHeld = true;
+            g_bSimI2CAddressed = ((ui32MSA >> 1) == SIM_OPT_ADDRESS);
+            g_ui32SimOptByte = 0;
+            if(!g_bSimI2CAddressed)
+            {
+                g_ui32SimI2CError = I2C_MCS_ERROR | I2C_MCS_ADRACK;
+            }
+        }
+        if(g_ui32SimI2CError == 0)
+        {
+            ui32Bits += 9;
+            if(ui32MSA & 0x01)
+            {
+                SimLookup(SIM_I2C1_MDR)->ui32Value = SimOptReadByte();
+            }
+            else
+            {
+                SimOptWriteByte(SimGet(SIM_I2C1_MDR));
+            }
+        }
+    }
+    if(ui32Command & I2C_MCS_STOP)
+    {
+        ui32Bits += 1;
+        g_bSimI2CHeld = false;
+    }
+    g_ui64SimI2CDone = g_ui64SimNow + (ui32Bits * SIM_I2C_BIT_CYCLES);
+}
+
+static uint32_t
+SimI2CStatus(void)
+{
+    if(g_ui64SimI2CDone != SIM_NEVER)
+    {
+        return(I2C_MCS_BUSY | I2C_MCS_BUSBSY);
+    }
+    return(g_ui32SimI2CError | (g_bSimI2CHeld ? I2C_MCS_BUSBSY : I2C_MCS_IDLE));
+}
+
+//*****************************************************************************
+//
+// ADC0 sequencer 2. One conversion runs every step up to the END step, one
+// sample time each, into the FIFO; the sequence interrupt is raised at the
+// end if any step asks for it.
+//
+//*****************************************************************************
+static void
+SimAdcStart(void)
+{
+    uint32_t ui32Ctl, i;
+
+    if(((SimGet(SIM_ADC0_ACTSS) & 0x04) == 0) ||
+       (g_ui64SimAdcDone != SIM_NEVER))
+    {
+        return;
+    }
+    ui32Ctl = SimGet(SIM_ADC0_SSCTL2);
+    for(i = 0; (i < 3) && !(ui32Ctl & (0x2 << (4 * i))); i++)
+    {
+    }
+    g_ui64SimAdcDone = g_ui64SimNow + ((i + 1) * SIM_ADC_SAMPLE_CYCLES);
+}
+
+static void
+SimAdcDone(void)
+{
+    uint32_t ui32Ctl, ui32Mux, i;
+    bool bInterrupt = false;
+
+    g_ui64SimAdcDone = SIM_NEVER;
+    ui32Ctl = SimGet(SIM_ADC0_SSCTL2);
+    ui32Mux = SimGet(SIM_ADC0_SSMUX2);
+    for(i = 0; i < 4; i++)
+    {
+        if(g_ui32SimFifoCount < 4)
+        {
+            g_pui16SimFifo[(g_ui32SimFifoRead + g_ui32SimFifoCount) & 3] =
+                g_pui16SimAnalog[((ui32Mux >> (4 * i)) & 0xF) % 12];
+            g_ui32SimFifoCount++;
+        }
+        bInterrupt |= (ui32Ctl & (0x4 << (4 * i))) != 0;
+        if(ui32Ctl & (0x2 << (4 * i)))
+        {
+            break;
+        }
+    }
+    if(bInterrupt)
+    {
+        g_ui32SimAdcRis |= 0x04;
+    }
+}
+
+static uint32_t
+SimAdcPop(void)
+{
+    uint32_t ui32Value;
+
+    if(g_ui32SimFifoCount == 0)
+    {
+        return(0);
+    }
+    ui32Value = g_pui16SimFifo[g_ui32SimFifoRead];
+    g_ui32SimFifoRead = (g_ui32SimFifoRead + 1) & 3;
+    g_ui32SimFifoCount--;
+    return(ui32Value);
+}
+
+
+//*****************************************************************************
+//
+// uDMA. A request moves one item for the channel's current control
+// structure and counts down its transfer size; the last item sets the
+// structure's mode back to STOP and raises the channel's completion. In
+// ping-pong mode the channel then carries on with its other structure; in
+// the others it is disabled, as it is when a request finds its structure
+// stopped. The only source bsp.c uses is the SS2 FIFO.
+//
+//*****************************************************************************
+static uint8_t *
+SimDmaHost(uint32_t ui32Addr)
+{
+    uint32_t ui32Map;
+
+    ui32Map = (ui32Addr - SIM_DMA_SRAM) / SIM_DMA_WINDOW;
+    if((ui32Addr < SIM_DMA_SRAM) || (ui32Map >= g_ui32SimDmaMaps))
+    {
+        g_ui32SimBusFaults++;
+        return(0);
+    }
+    return(g_ppui8SimDmaMap[ui32Map] +
+           (int32_t)(ui32Addr - (SIM_DMA_SRAM + (ui32Map * SIM_DMA_WINDOW) +
+                                 (SIM_DMA_WINDOW / 2))));
+}
+
+static bool
+SimDmaMove(uint32_t ui32Channel)
+{
+    uint32_t *pui32Entry, ui32Ctl, ui32Items, ui32Size, ui32Inc, ui32Value;
+    uint8_t *pui8Dst;
+
+    pui32Entry = (uint32_t *)SimDmaHost(SimGet(SIM_UDMA_CTLBASE));
+    if(pui32Entry == 0)
+    {
+        return(false);
+    }
+    pui32Entry += (4 * ui32Channel) +
+                  ((g_ui32SimDmaAlt & (1 << ui32Channel)) ? 128 : 0);
+    ui32Ctl = pui32Entry[2];
+    if((ui32Ctl & UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_STOP)
+    {
+        g_ui32SimDmaEnabled &= ~(1 << ui32Channel);
+        return(false);
+    }
+    if(pui32Entry[0] != SIM_ADC0_SSFIFO2)
+    {
+        g_ui32SimBusFaults++;
+        return(false);
+    }
+
+    ui32Items = ((ui32Ctl & UDMA_CHCTL_XFERSIZE_M) >> 4) + 1;
+    ui32Size = 1 << ((ui32Ctl & UDMA_CHCTL_DSTSIZE_M) >> 28);
+    ui32Inc = ((ui32Ctl & UDMA_CHCTL_DSTINC_M) == UDMA_CHCTL_DSTINC_NONE) ?
+              0 : (1 << ((ui32Ctl & UDMA_CHCTL_DSTINC_M) >> 30));
+    pui8Dst = SimDmaHost(pui32Entry[1] - ((ui32Items - 1) * ui32Inc));
+    if(pui8Dst == 0)
+    {
+        return(false);
+    }
+    ui32Value = SimAdcPop();
+    memcpy(pui8Dst, &ui32Value, ui32Size);
+
+    if(ui32Items > 1)
+    {
+        pui32Entry[2] = ui32Ctl - (1 << 4);
+        return(true);
+    }
+    pui32Entry[2] = ui32Ctl & ~(UDMA_CHCTL_XFERSIZE_M | UDMA_CHCTL_XFERMODE_M);
+    g_ui32SimDmaChis |= 1 << ui32Channel;
+    if((ui32Ctl & UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_PINGPONG)
+    {
+        g_ui32SimDmaAlt ^= 1 << ui32Channel;
+    }
+    else
+    {
+        g_ui32SimDmaEnabled &= ~(1 << ui32Channel);
+    }
+    return(true);
+}
+
+//
+// SS2 requests a transfer for each result in its FIFO, if its channel is
+// enabled and mapped to it.
+//
+static void
+SimDmaAdc(void)
+{
+    if(((SimGet(SIM_UDMA_CFG) & UDMA_CFG_MASTEN) == 0) ||
+       ((g_ui32SimDmaEnabled & (1 << SIM_DMA_ADC_CH)) == 0) ||
+       ((SimGet(SIM_UDMA_CHMAP2) & UDMA_CHMAP2_CH16SEL_M) != 0))
+    {
+        return;
+    }
+    while(g_ui32SimFifoCount && SimDmaMove(SIM_DMA_ADC_CH))
+    {
+    }
+}
+
+//*****************************************************************************
+//
+// Timer0A. Each time-out reloads from TAILR, so a new period takes effect
+// at the next one, and triggers SS2 when the timer is its trigger source.
+//
+//*****************************************************************************
+static void
+SimTimerDone(void)
+{
+    g_ui64SimTimerNext += (uint64_t)SimGet(SIM_TIMER0_TAILR) + 1;
+    if((SimGet(SIM_TIMER0_CTL) & TIMER_CTL_TAOTE) &&
+       ((SimGet(SIM_ADC0_EMUX) & ADC_EMUX_EM2_M) == ADC_EMUX_EM2_TIMER))
+    {
+        SimAdcStart();
+    }
+}
+
+//*****************************************************************************
+//
+// Runs every peripheral event due by ui64Until, in time order.
+//
+//*****************************************************************************
+static uint64_t
+SimNextEvent(void)
+{
+    uint64_t ui64Next = g_ui64SimAdcDone;
+
+    if(g_ui64SimTimerNext < ui64Next)
+    {
+        ui64Next = g_ui64SimTimerNext;
+    }
+    if(g_ui64SimI2CDone < ui64Next)
+    {
+        ui64Next = g_ui64SimI2CDone;
+    }
+    if(g_ui64SimOptDone < ui64Next)
+    {
+        ui64Next = g_ui64SimOptDone;
+    }
+    return(ui64Next);
+}
+
+static void
+SimAdvance(uint64_t ui64Until)
+{
+    uint64_t ui64Next;
+
+    while((ui64Next = SimNextEvent()) <= ui64Until)
+    {
+        g_ui64SimNow = ui64Next;
+        if(ui64Next == g_ui64SimAdcDone)
+        {
+            SimAdcDone();
+            SimDmaAdc();
+        }
+        else if(ui64Next == g_ui64SimTimerNext)
+        {
+            SimTimerDone();
+        }
+        else if(ui64Next == g_ui64SimI2CDone)
+        {
+            g_ui64SimI2CDone = SIM_NEVER;
+            g_ui32SimI2CRis = 1;
+        }
+        else
+        {
+            SimOptDone();
+        }
+    }
+    if(g_ui64SimNow < ui64Until)
+    {
+        g_ui64SimNow = ui64Until;
+    }
+}
+
+//*****************************************************************************
+//
+// What a read of a register sees now, and what a write to it does. Trigger
+// and clear registers read as zero, so that any write to them shows.
+//
+//*****************************************************************************
+static uint32_t
+SimRead(uint32_t ui32Addr, uint32_t ui32Stored)
+{
+    if((ui32Addr >= SIM_GPIOA_DATA) && (ui32Addr <= SIM_GPIOA_DATA_END))
+    {
+        return(g_ui8SimPortA & ((ui32Addr - SIM_GPIOA_DATA) >> 2));
+    }
+    if((ui32Addr >= SIM_SYSCTL_PR) && (ui32Addr <= SIM_SYSCTL_PR_END))
+    {
+        return(0xFFFFFFFF);             // every peripheral ready at once
+    }
+    switch(ui32Addr)
+    {
+        case SIM_ADC0_RIS:
+            return(g_ui32SimAdcRis);
+        case SIM_ADC0_SSFIFO2:
+            return(SimAdcPop());
+        case SIM_GPIOA_RIS:
+            return(g_ui32SimPortARis);
+        case SIM_GPIOA_MIS:
+            return(g_ui32SimPortARis & SimGet(SIM_GPIOA_IM));
+        case SIM_I2C1_MCS:
+            return(SimI2CStatus());
+        case SIM_I2C1_MRIS:
+            return(g_ui32SimI2CRis);
+        case SIM_I2C1_MMIS:
+            return(g_ui32SimI2CRis & SimGet(SIM_I2C1_MIMR));
+        case SIM_NVIC_EN0:
+            return(g_pui32SimNvicEnabled[0]);
+        case SIM_NVIC_EN1:
+            return(g_pui32SimNvicEnabled[1]);
+        case SIM_SYSCTL_RIS:
+            return(SYSCTL_RIS_PLLLRIS);  // the PLL locks at once
+        case SIM_DWT_CYCCNT:
+            if((SimGet(SIM_DEMCR) & 0x01000000) &&
+               (SimGet(SIM_DWT_CTRL) & 0x00000001))
+            {
+                return((uint32_t)g_ui64SimNow + g_ui32SimCycOffset);
+            }
+            return(ui32Stored);
+        case SIM_ADC0_ISC:
+        case SIM_ADC0_PSSI:
+        case SIM_GPIOA_ICR:
+        case SIM_I2C1_MICR:
+        case SIM_NVIC_DIS0:
+        case SIM_NVIC_DIS1:
+        case SIM_UDMA_ENASET:
+        case SIM_UDMA_ENACLR:
+        case SIM_UDMA_ALTSET:
+        case SIM_UDMA_ALTCLR:
+        case SIM_UDMA_CHIS:
+            return(0);
+        default:
+            return(ui32Stored);
+    }
+}
+
+static void
+SimWrite(tSimReg *psReg, uint32_t ui32Old)
+{
+    uint32_t ui32New = psReg->ui32Value;
+
+    switch(psReg->ui32Addr)
+    {
+        case SIM_ADC0_ISC:
+            g_ui32SimAdcRis &= ~ui32New;
+            break;
+        case SIM_ADC0_PSSI:
+            if(ui32New & 0x04)
+            {
+                SimAdcStart();
+            }
+            break;
+        case SIM_TIMER0_CTL:
+            if((ui32New & TIMER_CTL_TAEN) == 0)
+            {
+                g_ui64SimTimerNext = SIM_NEVER;
+            }
+            else if((ui32Old & TIMER_CTL_TAEN) == 0)
+            {
+                g_ui64SimTimerNext = g_ui64SimNow +
+                                     SimGet(SIM_TIMER0_TAILR) + 1;
+            }
+            break;
+        case SIM_GPIOA_ICR:
+            g_ui32SimPortARis &= ~ui32New;
+            break;
+        case SIM_I2C1_MCS:
+            SimI2CCommand(ui32New);
+            break;
+        case SIM_I2C1_MICR:
+            g_ui32SimI2CRis &= ~ui32New;
+            break;
+        case SIM_NVIC_EN0:
+            g_pui32SimNvicEnabled[0] |= ui32New;
+            break;
+        case SIM_NVIC_EN1:
+            g_pui32SimNvicEnabled[1] |= ui32New;
+            break;
+        case SIM_NVIC_DIS0:
+            g_pui32SimNvicEnabled[0] &= ~ui32New;
+            break;
+        case SIM_NVIC_DIS1:
+            g_pui32SimNvicEnabled[1] &= ~ui32New;
+            break;
+        case SIM_DWT_CTRL:
+            if((ui32New & ~ui32Old) & 0x00000001)
+            {
+                g_ui32SimCycOffset = SimGet(SIM_DWT_CYCCNT) -
+                                     (uint32_t)g_ui64SimNow;
+            }
+            else if((ui32Old & ~ui32New) & 0x00000001)
+            {
+                SimLookup(SIM_DWT_CYCCNT)->ui32Value =
+                    (uint32_t)g_ui64SimNow + g_ui32SimCycOffset;
+            }
+            break;
+        case SIM_DWT_CYCCNT:
+            g_ui32SimCycOffset = ui32New - (uint32_t)g_ui64SimNow;
+            break;
+        case SIM_UDMA_ENASET:
+            g_ui32SimDmaEnabled |= ui32New;
+            break;
+        case SIM_UDMA_ENACLR:
+            g_ui32SimDmaEnabled &= ~ui32New;
+            break;
+        case SIM_UDMA_ALTSET:
+            g_ui32SimDmaAlt |= ui32New;
+            break;
+        case SIM_UDMA_ALTCLR:
+            g_ui32SimDmaAlt &= ~ui32New;
+            break;
+        case SIM_UDMA_CHIS:
+            g_ui32SimDmaChis &= ~ui32New;
+            break;
+        default:
+            break;
+    }
+}
+
+//*****************************************************************************
+//
+// Finishes the access in progress.
+//
+//*****************************************************************************
+static void
+SimFlush(void)
+{
+    tSimReg *psReg = g_psSimPending;
+
+    g_psSimPending = 0;
+    if(psReg && (psReg->ui32Value != g_ui32SimPendingValue))
+    {
+        SimWrite(psReg, g_ui32SimPendingValue);
+    }
+}
+
+//*****************************************************************************
+//
+// Takes every interrupt that is enabled, pending and not masked, lowest IRQ
+// number first, as the NVIC would. Handlers do not nest.
+//
+//*****************************************************************************
+static void
+SimInterrupts(void)
+{
+    if(g_ui32SimPrimask || g_bSimInHandler)
+    {
+        return;
+    }
+    g_bSimInHandler = true;
+    while(1)
+    {
+        if((g_pui32SimNvicEnabled[0] & (1 << 0)) &&
+           (g_ui32SimPortARis & SimGet(SIM_GPIOA_IM)))
+        {
+            GPIOPortA_Handler();
+        }
+        else if((g_pui32SimNvicEnabled[0] & (1 << 16)) &&
+                ((g_ui32SimAdcRis & SimGet(SIM_ADC0_IM) & 0x04) ||
+                 (g_ui32SimDmaChis & (1 << SIM_DMA_ADC_CH))))
+        {
+            ADC0Seq2_Handler();
+        }
+        else if((g_pui32SimNvicEnabled[1] & (1 << (37 - 32))) &&
+                (g_ui32SimI2CRis & SimGet(SIM_I2C1_MIMR)))
+        {
+            I2C1_Handler();
+        }
+        else
+        {
+            break;
+        }
+        SimFlush();
+    }
+    g_bSimInHandler = false;
+}
+
+//*****************************************************************************
+//
+// The register access hook behind every register name in bsp.c. The
+// previous access is finished, time moves on and any interrupt is taken, as
+// between two instructions, and then the register is loaded with what a
+// read would see.
+//
+//*****************************************************************************
+volatile uint32_t *
+SimRegister(uint32_t ui32Addr)
+{
+    tSimReg *psReg;
+
+    SimFlush();
+    SimAdvance(g_ui64SimNow + SIM_ACCESS_CYCLES);
+    SimInterrupts();
+
+    if((ui32Addr >= SIM_TIMER0) && (ui32Addr <= SIM_TIMER0_END) &&
+       ((SimGet(SIM_SYSCTL_RCGCTIMER) & 0x01) == 0))
+    {
+        g_ui32SimBusFaults++;
+    }
+
+    psReg = SimLookup(ui32Addr);
+    psReg->ui32Value = SimRead(ui32Addr, psReg->ui32Value);
+    g_psSimPending = psReg;
+    g_ui32SimPendingValue = psReg->ui32Value;
+    return(&psReg->ui32Value);
+}
+
+uint32_t
+SimDMAAddress(void *pvHost)
+{
+    uint32_t i;
+
+    for(i = 0; (i < g_ui32SimDmaMaps) && (g_ppui8SimDmaMap[i] != pvHost); i++)
+    {
+    }
+    if(i == SIM_DMA_MAPS)
+    {
+        return(0);
+    }
+    if(i == g_ui32SimDmaMaps)
+    {
+        g_ppui8SimDmaMap[g_ui32SimDmaMaps++] = pvHost;
+    }
+    return(SIM_DMA_SRAM + (i * SIM_DMA_WINDOW) + (SIM_DMA_WINDOW / 2));
+}
+
+uint32_t
+SimDisableInterrupts(void)
+{
+    uint32_t ui32Primask = g_ui32SimPrimask;
+
+    SimFlush();
+    g_ui32SimPrimask = 1;
+    return(ui32Primask);
+}
+
+void
+SimRestoreInterrupts(uint32_t ui32Primask)
+{
+    SimFlush();
+    g_ui32SimPrimask = ui32Primask;
+    SimInterrupts();
+}
+
+//*****************************************************************************
+//
+// Lets ui32Cycles pass, taking interrupts as events raise them.
+//
+//*****************************************************************************
+void
+SimRun(uint32_t ui32Cycles)
+{
+    uint64_t ui64End, ui64Next;
+
+    ui64End = g_ui64SimNow + ui32Cycles;
+    SimFlush();
+    SimInterrupts();
+    while(g_ui64SimNow < ui64End)
+    {
+        ui64Next = SimNextEvent();
+        SimAdvance((ui64Next < ui64End) ? ui64Next : ui64End);
+        SimInterrupts();
+    }
+}
+
+uint64_t
+SimCycles(void)
+{
+    return(g_ui64SimNow);
+}
+
+void
+SimSetAnalog(int iChannel, uint16_t ui16Code)
+{
+    g_pui16SimAnalog[iChannel % 12] = ui16Code & 0x0FFF;
+}
+
+
+void
+SimSetLight(uint16_t ui16Result)
+{
+    g_ui16SimLight = ui16Result;
+}
+
+//*****************************************************************************
+//
+// Puts the model in its power-on state at time 0.
+//
+//*****************************************************************************
+void
+SimReset(void)
+{
+    memset(g_psSimRegs, 0, sizeof(g_psSimRegs));
+    g_psSimPending = 0;
+    g_ui64SimNow = 0;
+    g_ui32SimPrimask = 0;
+    g_bSimInHandler = false;
+    g_pui32SimNvicEnabled[0] = g_pui32SimNvicEnabled[1] = 0;
+
+    memset(g_pui16SimAnalog, 0, sizeof(g_pui16SimAnalog));
+    g_ui32SimFifoCount = g_ui32SimFifoRead = 0;
+    g_ui32SimAdcRis = 0;
+    g_ui64SimAdcDone = SIM_NEVER;
+    g_ui64SimTimerNext = SIM_NEVER;
+    g_ui32SimBusFaults = 0;
+
+    g_ui32SimDmaEnabled = 0;
+    g_ui32SimDmaAlt = 0;
+    g_ui32SimDmaChis = 0;
+    memset(g_ppui8SimDmaMap, 0, sizeof(g_ppui8SimDmaMap));
+    g_ui32SimDmaMaps = 0;
+
+    g_ui32SimI2CError = 0;
+    g_bSimI2CHeld = false;
+    g_bSimI2CAddressed = false;
+    g_ui32SimI2CRis = 0;
+    g_ui64SimI2CDone = SIM_NEVER;
+
+    g_pui16SimOpt[0] = 0x0000;
+    g_pui16SimOpt[1] = 0xC810;
+    g_pui16SimOpt[2] = 0x0000;
+    g_pui16SimOpt[3] = 0xBFFF;
+    g_ui8SimOptPointer = 0;
+    g_ui32SimOptByte = 0;
+    g_bSimOptInt = false;
+    g_ui16SimLight = 0;
+    g_ui64SimOptDone = SIM_NEVER;
+
+    g_ui8SimPortA = 0xFF;
+    g_ui32SimPortARis = 0;
+
+    g_ui32SimCycOffset = 0;
+}
+
+//*****************************************************************************
+//
+// The driver checks.
+//
+//*****************************************************************************
+#define SIM_MS(ms)                 ((SIM_CLOCK_HZ / 1000) * (ms))
+
+static volatile uint32_t g_ui32TaskCalls;
+
+static void
+SimTask(void)
+{
+    g_ui32TaskCalls++;
+}
+
+static void
+SimStart(void)
+{
+    SimReset();
+    BSP_Clock_SetFrequency(SIM_CLOCK_HZ);
+    g_ui32TaskCalls = 0;
+}
+
+static void
+CheckAccelerometer(void)
+{
+    const uint16_t *pui16Block;
+    uint16_t ui16X, ui16Y, ui16Z;
+
+    SimStart();
+    SimSetAnalog(7, 0x800);             // x on PD0
+    SimSetAnalog(6, 0x400);             // y on PD1
+    SimSetAnalog(5, 0xFFC);             // z on PD2
+    BSP_Accelerometer_Init();
+
+    //
+    // The idle hook asks before Timer0 has ever been clocked.
+    //
+    CHECK(!BSP_Accelerometer_Busy() && (g_ui32SimBusFaults == 0),
+          "idle with Timer0 unclocked");
+
+    BSP_Accelerometer_Input(&ui16X, &ui16Y, &ui16Z);
+    CHECK((ui16X == 0x200) && (ui16Y == 0x100) && (ui16Z == 0x3FF),
+          "polled sample");
+
+    BSP_Accelerometer_InitInterrupt(SimTask, 3);
+    CHECK(!BSP_Accelerometer_End(&ui16X, &ui16Y, &ui16Z),
+          "no sample before start");
+    BSP_Accelerometer_Start();
+    SimRun(SIM_MS(1));
+    CHECK(g_ui32TaskCalls == 1, "one interrupt per sample");
+    CHECK(BSP_Accelerometer_End(&ui16X, &ui16Y, &ui16Z) &&
+          (ui16X == 0x200) && (ui16Y == 0x100) && (ui16Z == 0x3FF),
+          "interrupt-driven sample");
+
+    //
+    // At 1 kHz the first block is full just after 16 ms. Holding the
+    // second one for 48 ms more lets the ISR fill the third and then drop
+    // a block's worth of samples.
+    //
+    g_ui32TaskCalls = 0;
+    BSP_Accelerometer_InitTimer(1000, SimTask, 3);
+    SimRun(SIM_MS(ACCEL_BLOCK_SAMPLES) + SIM_MS(1) / 10);
+    pui16Block = BSP_Accelerometer_GetBlock();
+    CHECK((g_ui32TaskCalls == 1) && (pui16Block != 0), "first block");
+    CHECK(pui16Block && (pui16Block[0] == 0x200) &&
+          (pui16Block[(3 * ACCEL_BLOCK_SAMPLES) - 1] == 0x3FF),
+          "block contents");
+    BSP_Accelerometer_ReleaseBlock();
+    SimRun(SIM_MS(3 * ACCEL_BLOCK_SAMPLES));
+    CHECK(g_ui32TaskCalls == 3, "a block per 16 ms");
+    CHECK(BSP_Accelerometer_Overruns() == ACCEL_BLOCK_SAMPLES,
+          "overruns while both blocks are held");
+    BSP_Accelerometer_StopTimer();
+    CHECK(!BSP_Accelerometer_Busy(), "idle once stopped");
+    CHECK(g_ui32SimBusFaults == 0, "Timer0 only touched while clocked");
+}
+
+//*****************************************************************************
+//
+// A pool of caller-supplied blocks for the DMA, and the blocks handed back
+// full.
+//
+//*****************************************************************************
+#define SIM_POOL_BLOCKS            4
+
+static uint16_t g_ppui16SimPool[SIM_POOL_BLOCKS][3 * ACCEL_BLOCK_SAMPLES];
+static uint16_t *g_ppui16SimFree[SIM_POOL_BLOCKS];
+static uint32_t g_ui32SimFree;
+static uint16_t *g_ppui16SimDone[8];
+static uint32_t g_ui32SimDone;
+
+static uint16_t *
+SimGetBlock(void)
+{
+    return(g_ui32SimFree ? g_ppui16SimFree[--g_ui32SimFree] : 0);
+}
+
+static void
+SimDoneBlock(uint16_t *pui16Block)
+{
+    if(g_ui32SimDone < 8)
+    {
+        g_ppui16SimDone[g_ui32SimDone] = pui16Block;
+    }
+    g_ui32SimDone++;
+}
+
+static void
+CheckAccelerometerDMA(void)
+{
+    const uint16_t *pui16First, *pui16Second, *pui16Block;
+    uint32_t ui32Calls, i;
+
+    SimStart();
+    SimSetAnalog(7, 0x800);
+    SimSetAnalog(6, 0x400);
+    SimSetAnalog(5, 0xFFC);
+    BSP_Accelerometer_Init();
+
+    //
+    // The primary structure fills the first block, the alternate the
+    // second, and each is re-armed behind the other. The DMA stores the raw
+    // 12-bit codes.
+    //
+    BSP_Accelerometer_InitDMA(1000, SimTask, 3);
+    SimRun(SIM_MS(ACCEL_BLOCK_SAMPLES) + SIM_MS(1) / 10);
+    pui16First = BSP_Accelerometer_GetBlock();
+    CHECK((g_ui32TaskCalls == 1) && (pui16First != 0), "first DMA block");
+    CHECK(pui16First && (pui16First[0] == 0x800) && (pui16First[1] == 0x400) &&
+          (pui16First[(3 * ACCEL_BLOCK_SAMPLES) - 1] == 0xFFC),
+          "DMA block contents");
+    BSP_Accelerometer_ReleaseBlock();
+
+    SimSetAnalog(7, 0x123);
+    SimRun(SIM_MS(ACCEL_BLOCK_SAMPLES));
+    pui16Second = BSP_Accelerometer_GetBlock();
+    CHECK((g_ui32TaskCalls == 2) && pui16Second &&
+          (pui16Second != pui16First) && (pui16Second[0] == 0x123),
+          "alternate structure fills the other block");
+    BSP_Accelerometer_ReleaseBlock();
+
+    SimRun(SIM_MS(ACCEL_BLOCK_SAMPLES));
+    pui16Block = BSP_Accelerometer_GetBlock();
+    CHECK((g_ui32TaskCalls == 3) && (pui16Block == pui16First) &&
+          (BSP_Accelerometer_Overruns() == 0),
+          "primary re-armed behind the alternate");
+    BSP_Accelerometer_ReleaseBlock();
+
+    //
+    // A block held past the next one's end is written over by the DMA.
+    //
+    SimRun(SIM_MS(ACCEL_BLOCK_SAMPLES));
+    pui16Block = BSP_Accelerometer_GetBlock();
+    SimRun(SIM_MS(ACCEL_BLOCK_SAMPLES));
+    CHECK((pui16Block == pui16Second) &&
+          (BSP_Accelerometer_Overruns() == ACCEL_BLOCK_SAMPLES),
+          "DMA overrun into a held block");
+    BSP_Accelerometer_ReleaseBlock();
+
+    BSP_Accelerometer_StopTimer();
+    SimRun(SIM_MS(1));
+    ui32Calls = g_ui32TaskCalls;
+    SimRun(SIM_MS(2 * ACCEL_BLOCK_SAMPLES));
+    CHECK((g_ui32TaskCalls == ui32Calls) && !BSP_Accelerometer_Busy(),
+          "DMA idle once stopped");
+
+    //
+    // Caller-supplied blocks: each full one is handed on and its half
+    // re-armed with a fresh one. With the pool empty the half is refilled
+    // and the samples count as overruns; a block given back is used again.
+    //
+    SimStart();
+    SimSetAnalog(7, 0x800);
+    SimSetAnalog(6, 0x400);
+    SimSetAnalog(5, 0xFFC);
+    BSP_Accelerometer_Init();
+    for(i = 0; i < SIM_POOL_BLOCKS; i++)
+    {
+        g_ppui16SimFree[i] = g_ppui16SimPool[i];
+    }
+    g_ui32SimFree = SIM_POOL_BLOCKS;
+    g_ui32SimDone = 0;
+    BSP_Accelerometer_InitDMABlocks(1000, SimGetBlock, SimDoneBlock, 3);
+    SimRun(SIM_MS(2 * ACCEL_BLOCK_SAMPLES) + SIM_MS(1) / 10);
+    CHECK((g_ui32SimDone == 2) &&
+          (g_ppui16SimDone[0] == g_ppui16SimPool[3]) &&
+          (g_ppui16SimDone[1] == g_ppui16SimPool[2]) &&
+          (g_ppui16SimDone[1][(3 * ACCEL_BLOCK_SAMPLES) - 1] == 0xFFC) &&
+          (g_ui32SimFree == 0), "caller blocks handed on in order");
+
+    SimRun(SIM_MS(2 * ACCEL_BLOCK_SAMPLES));
+    CHECK((g_ui32SimDone == 2) &&
+          (BSP_Accelerometer_Overruns() == (2 * ACCEL_BLOCK_SAMPLES)),
+          "blocks refilled while the pool is empty");
+
+    g_ppui16SimFree[g_ui32SimFree++] = g_ppui16SimDone[0];
+    SimRun(SIM_MS(ACCEL_BLOCK_SAMPLES));
+    CHECK((g_ui32SimDone == 3) && (g_ppui16SimDone[2] == g_ppui16SimPool[1]) &&
+          (g_ui32SimFree == 0), "a block given back is used again");
+
+    BSP_Accelerometer_StopTimer();
+    SimRun(SIM_MS(1));
+    CHECK(g_ui32SimBusFaults == 0, "DMA only to mapped memory");
+}
+
+//*****************************************************************************
+//
+// I2C transactions, each recorded by its done callback in the order they
+// end.
+//
+//*****************************************************************************
+static I2CTransaction_t *g_ppsSimEnded[4];
+static uint32_t g_ui32SimEnded;
+
+static void
+SimEnded(I2CTransaction_t *psTransaction)
+{
+    if(g_ui32SimEnded < 4)
+    {
+        g_ppsSimEnded[g_ui32SimEnded] = psTransaction;
+    }
+    g_ui32SimEnded++;
+}
+
+static void
+SimTransaction(I2CTransaction_t *psTransaction, uint8_t ui8Slave,
+               uint8_t ui8Pointer, uint8_t ui8Read)
+{
+    memset(psTransaction, 0, sizeof(*psTransaction));
+    psTransaction->slave = ui8Slave;
+    psTransaction->wlen = 1;
+    psTransaction->wdata[0] = ui8Pointer;
+    psTransaction->rlen = ui8Read;
+    psTransaction->done = SimEnded;
+}
+
+static void
+CheckI2C(void)
+{
+    I2CTransaction_t psTransactions[3];
+    uint32_t ui32Rate;
+
+    SimStart();
+    BSP_LightSensor_Init();
+    g_ui32SimEnded = 0;
+
+    //
+    // A register write, then a write of the pointer and a read of the
+    // register back after a repeated START.
+    //
+    SimTransaction(&psTransactions[0], SIM_OPT_ADDRESS, 0x01, 0);
+    psTransactions[0].wlen = 3;
+    psTransactions[0].wdata[1] = 0xC4;
+    psTransactions[0].wdata[2] = 0x10;
+    BSP_I2C_Submit(&psTransactions[0]);
+    CHECK(psTransactions[0].status == I2C_PENDING, "pending while on the bus");
+    SimRun(SIM_MS(1));
+    CHECK((psTransactions[0].status == 0) && (g_pui16SimOpt[1] == 0xC410) &&
+          (g_ui32SimEnded == 1), "register write");
+    SimTransaction(&psTransactions[0], SIM_OPT_ADDRESS, 0x01, 2);
+    BSP_I2C_Submit(&psTransactions[0]);
+    SimRun(SIM_MS(1));
+    CHECK((psTransactions[0].status == 0) &&
+          (psTransactions[0].rdata[0] == 0xC4) &&
+          (psTransactions[0].rdata[1] == 0x10), "register read back");
+
+    //
+    // Three at once run in the order submitted. Nobody answers at 0x45, so
+    // the second is retried and then given up, and the bus is released
+    // for the third.
+    //
+    g_ui32SimEnded = 0;
+    SimTransaction(&psTransactions[0], SIM_OPT_ADDRESS, 0x7E, 2);
+    SimTransaction(&psTransactions[1], SIM_OPT_ADDRESS + 1, 0x00, 2);
+    SimTransaction(&psTransactions[2], SIM_OPT_ADDRESS, 0x7F, 2);
+    BSP_I2C_Submit(&psTransactions[0]);
+    BSP_I2C_Submit(&psTransactions[1]);
+    BSP_I2C_Submit(&psTransactions[2]);
+    SimRun(SIM_MS(10));
+    CHECK((g_ui32SimEnded == 3) && (g_ppsSimEnded[0] == &psTransactions[0]) &&
+          (g_ppsSimEnded[1] == &psTransactions[1]) &&
+          (g_ppsSimEnded[2] == &psTransactions[2]), "queued in order");
+    CHECK((psTransactions[0].status == 0) &&
+          (psTransactions[0].rdata[0] == 0x54) &&
+          (psTransactions[0].rdata[1] == 0x49), "manufacturer ID");
+    CHECK(psTransactions[1].status == (I2C_MCS_ERROR | I2C_MCS_ADRACK),
+          "address not acknowledged");
+    CHECK((psTransactions[2].status == 0) &&
+          (psTransactions[2].rdata[0] == 0x30) &&
+          (psTransactions[2].rdata[1] == 0x01), "device ID after a failure");
+    CHECK(!g_bSimI2CHeld && (g_ui64SimI2CDone == SIM_NEVER), "bus idle");
+
+    //
+    // A new speed is programmed at the next transaction, not while the bus
+    // may be busy: 400 kbps at 50 MHz rounds TPR up from 5.25 to 6, which
+    // is 357 kbps.
+    //
+    CHECK(SimGet(SIM_I2C1_MTPR) == 24, "100 kbps TPR");
+    ui32Rate = BSP_I2C_SetSpeed(I2C_SPEED_FAST);
+    CHECK((ui32Rate == 357142) && (SimGet(SIM_I2C1_MTPR) == 24),
+          "400 kbps requested, not yet programmed");
+    SimTransaction(&psTransactions[0], SIM_OPT_ADDRESS, 0x7F, 2);
+    BSP_I2C_Submit(&psTransactions[0]);
+    SimRun(SIM_MS(1));
+    CHECK(SimGet(SIM_I2C1_MTPR) == 6, "400 kbps TPR programmed");
+    CHECK((psTransactions[0].status == 0) &&
+          (psTransactions[0].rdata[0] == 0x30) &&
+          (psTransactions[0].rdata[1] == 0x01), "device ID at 400 kbps");
+}
+
+static void
+CheckLightSensor(void)
+{
+    uint32_t ui32Light, ui32Offset, ui32Stops, ui32Restarts;
+
+    SimStart();
+    SimSetLight(0x3123);                // exponent 3, mantissa 0x123
+    BSP_LightSensor_Init();
+
+    CHECK(BSP_LightSensor_Input() == (8 * 0x123), "polled measurement");
+
+    //
+    // 100 ms conversions, each read out from the PA5 interrupt.
+    //
+    BSP_LightSensor_InitInterrupt(SimTask, 5);
+    BSP_LightSensor_StartContinuous(LIGHT_CONVERSION_100MS);
+    SimRun(SIM_MS(350));
+    CHECK(g_ui32TaskCalls == 3, "a reading per 100 ms");
+    CHECK(BSP_LightSensor_End(&ui32Light) && (ui32Light == (8 * 0x123)),
+          "continuous reading");
+    SimSetLight(0x0456);
+    SimRun(SIM_MS(100));
+    CHECK(BSP_LightSensor_End(&ui32Light) && (ui32Light == 0x456),
+          "reading follows the light");
+    BSP_LightSensor_StopContinuous();
+    g_ui32TaskCalls = 0;
+    SimRun(SIM_MS(300));
+    CHECK(g_ui32TaskCalls == 0, "no readings once stopped");
+    CHECK(!BSP_I2C_Busy(), "bus idle once stopped");
+
+    //
+    // Sweep a stop across the end of the first conversion, so that INT
+    // fires before, during and after the shutdown write. Once stopped, no
+    // reading may arrive and the bus must go idle; a restart, whether made
+    // at once (as a new rate is) or later, must run normally.
+    //
+    ui32Stops = ui32Restarts = 0;
+    for(ui32Offset = 0; ui32Offset < 40; ui32Offset++)
+    {
+        SimStart();
+        SimSetLight(0x0456);
+        BSP_LightSensor_Init();
+        BSP_LightSensor_InitInterrupt(SimTask, 5);
+        BSP_LightSensor_StartContinuous(LIGHT_CONVERSION_100MS);
+        SimRun(SIM_MS(99) + ((SIM_MS(1) / 10) * (ui32Offset / 2)));
+        BSP_LightSensor_StopContinuous();
+        g_ui32TaskCalls = 0;
+        if(ui32Offset & 1)
+        {
+            SimRun(SIM_MS(5));
+            ui32Stops += (g_ui32TaskCalls == 0) && !BSP_I2C_Busy() &&
+                         !BSP_LightSensor_Ready();
+        }
+        BSP_LightSensor_StartContinuous(LIGHT_CONVERSION_100MS);
+        g_ui32TaskCalls = 0;
+        SimRun(SIM_MS(250));
+        ui32Restarts += (g_ui32TaskCalls == 2) &&
+                        BSP_LightSensor_End(&ui32Light) &&
+                        (ui32Light == 0x456);
+
+        //
+        // SimStart() resets the model, not the driver, so leave it idle.
+        //
+        BSP_LightSensor_StopContinuous();
+        SimRun(SIM_MS(5));
+    }
+    CHECK(ui32Stops == 20, "nothing read after a stop");
+    CHECK(ui32Restarts == 40, "restart after a stop");
+}
+
+int
+main(int argc, char *argv[])
+{
+    if((argc == 2) && (strcmp(argv[1], "-b") == 0))
+    {
+#if BENCH_MODE
+        SimStart();
+        BenchRun();
+        return(0);
+#else
+        fprintf(stderr, "-b needs a build with -DBENCH_MODE=1\n");
+        return(1);
+#endif
+    }
+
+    CheckAccelerometer();
+    CheckAccelerometerDMA();
+    CheckI2C();
+    CheckLightSensor();
+    return(CHECK_SUMMARY());
+}
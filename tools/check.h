@@ -0,0 +1,47 @@
+//*****************************************************************************
+//
+// check.h - Shared by the host programs in this directory.
+//
+// Everything in tools/ is built and run on a PC, not on the LaunchPad. The
+// CCS project builds every source under its root, so the tools folder must
+// be excluded from it once (Exclude from Build on the folder's context
+// menu). Every file here includes this header, which stops a target build
+// that has not done so.
+//
+// The checks count themselves through CHECK(), which prints the line of
+// each one that fails, and end main() with CHECK_SUMMARY(), which prints
+// the totals and is the exit status: non-zero if any check failed. Include
+// this header from one file of each program only.
+//
+//*****************************************************************************
+
+#ifndef __CHECK_H__
+#define __CHECK_H__
+
+#if defined(__TI_COMPILER_VERSION__)
+#error "tools/ holds host programs; exclude it from the CCS build"
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+uint32_t g_ui32Checks;
+uint32_t g_ui32Failures;
+
+#define CHECK(bCondition, pcWhat)                                           \
+    do                                                                      \
+    {                                                                       \
+        g_ui32Checks++;                                                     \
+        if(!(bCondition))                                                   \
+        {                                                                   \
+            g_ui32Failures++;                                               \
+            printf("FAIL line %d: %s\n", __LINE__, pcWhat);                 \
+        }                                                                   \
+    }                                                                       \
+    while(0)
+
+#define CHECK_SUMMARY()                                                     \
+    (printf("%u checks, %u failed\n", g_ui32Checks, g_ui32Failures),        \
+     (g_ui32Failures != 0))
+
+#endif // __CHECK_H__
@@ -0,0 +1,219 @@
+//*****************************************************************************
+//
+// console_test.c - Host check of the command line parser.
+//
+// Feeds canned byte streams through ConsoleFeed(), as the Sensor task does
+// with the bytes received on UART0, and checks what each line runs:
+// backspace and delete editing, lines ended by CR, LF and CR/LF pairs, too
+// many words, lines longer than the buffer, unknown commands and bad
+// numbers. The exit status is non-zero if any check fails.
+//
+// Build and run on the host:
+//
+//   cc -std=gnu99 -I.. -o console_test console_test.c ../console.c
+//   ./console_test
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "check.h"
+#include "console.h"
+
+//*****************************************************************************
+//
+// The commands. Each one records how it was called; rate also takes a
+// number, as the firmware's does.
+//
+//*****************************************************************************
+static uint32_t g_ui32Runs;
+static int g_iArgc;
+static char g_pcArgs[CONSOLE_LINE_SIZE];
+static uint32_t g_ui32Rate;
+
+static void
+Record(int argc, char *argv[])
+{
+    int i;
+
+    g_ui32Runs++;
+    g_iArgc = argc;
+    g_pcArgs[0] = '\0';
+    for(i = 0; i < argc; i++)
+    {
+        if(i)
+        {
+            strcat(g_pcArgs, ",");
+        }
+        strcat(g_pcArgs, argv[i]);
+    }
+}
+
+static int
+CmdEcho(int argc, char *argv[])
+{
+    Record(argc, argv);
+    return(CONSOLE_OK);
+}
+
+static int
+CmdRate(int argc, char *argv[])
+{
+    Record(argc, argv);
+    if((argc != 2) || !ConsoleNumber(argv[1], &g_ui32Rate))
+    {
+        return(CONSOLE_BAD_ARGS);
+    }
+    return(CONSOLE_OK);
+}
+
+static const tConsoleCommand g_psCommands[] =
+{
+    { "echo", CmdEcho, "echo [words]" },
+    { "rate", CmdRate, "rate <Hz>" },
+};
+
+static tConsole g_sConsole;
+
+//*****************************************************************************
+//
+// Feeds pcBytes to the console and stores the result of each line that
+// ended in pi32Results, up to ui32Max of them. Returns the number of lines
+// that ended.
+//
+//*****************************************************************************
+static uint32_t
+Feed(const char *pcBytes, int *pi32Results, uint32_t ui32Max)
+{
+    uint32_t ui32Lines = 0;
+    int iResult;
+
+    g_ui32Runs = 0;
+    g_iArgc = 0;
+    g_pcArgs[0] = '\0';
+    for(; *pcBytes; pcBytes++)
+    {
+        iResult = ConsoleFeed(&g_sConsole, *pcBytes);
+        if(iResult != CONSOLE_PENDING)
+        {
+            if(ui32Lines < ui32Max)
+            {
+                pi32Results[ui32Lines] = iResult;
+            }
+            ui32Lines++;
+        }
+    }
+    return(ui32Lines);
+}
+
+int
+main(void)
+{
+    char pcLine[CONSOLE_LINE_SIZE + 8];
+    int piResults[4];
+    uint32_t ui32Value;
+
+    ConsoleInit(&g_sConsole, g_psCommands,
+                sizeof(g_psCommands) / sizeof(g_psCommands[0]));
+
+    //
+    // A plain command, with spaces and tabs between the words.
+    //
+    CHECK((Feed("rate  \t250\r", piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_OK) && (g_ui32Runs == 1) &&
+          (strcmp(g_pcArgs, "rate,250") == 0) && (g_ui32Rate == 250),
+          "rate 250 runs once with one argument");
+    CHECK((Feed("   \r", piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_EMPTY) && (g_ui32Runs == 0),
+          "a blank line runs nothing");
+
+    //
+    // Backspace and delete remove the last character, and do nothing on an
+    // empty line.
+    //
+    CHECK((Feed("\b\x7F\bratx\by 9\b\b 12\r", piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_BAD_CMD) && (g_ui32Runs == 0),
+          "backspace keeps what was typed after it");
+    CHECK((Feed("\b\x7F\bratx\be 9\b\b 12\r", piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_OK) &&
+          (strcmp(g_pcArgs, "rate,12") == 0) && (g_ui32Rate == 12),
+          "backspace and delete edit the line");
+
+    //
+    // Each CR or LF ends a line, so the LF of a CR/LF pair ends an empty
+    // one, which runs nothing and reports nothing; the command runs once.
+    //
+    CHECK((Feed("echo a\r\n", piResults, 4) == 2) &&
+          (piResults[0] == CONSOLE_OK) && (piResults[1] == CONSOLE_EMPTY) &&
+          (g_ui32Runs == 1), "CR/LF runs the command once");
+    CHECK((Feed("echo b\n\recho c\n", piResults, 4) == 3) &&
+          (piResults[0] == CONSOLE_OK) && (piResults[1] == CONSOLE_EMPTY) &&
+          (piResults[2] == CONSOLE_OK) && (g_ui32Runs == 2) &&
+          (strcmp(g_pcArgs, "echo,c") == 0), "LF/CR and LF end lines");
+
+    //
+    // CONSOLE_MAX_ARGS words, including the command, are accepted; one
+    // more is refused without running anything.
+    //
+    CHECK((Feed("echo 1 2 3\r", piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_OK) && (g_iArgc == CONSOLE_MAX_ARGS),
+          "the most words run");
+    CHECK((Feed("echo 1 2 3 4\r", piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_TOO_MANY_ARGS) && (g_ui32Runs == 0),
+          "one word too many is refused");
+    CHECK((Feed("rate\r", piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_BAD_ARGS) && (g_ui32Runs == 1),
+          "rate needs a number");
+    CHECK((Feed("rate 4294967296\r", piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_BAD_ARGS),
+          "rate refuses a number over 32 bits");
+    CHECK((Feed("rate 12x\r", piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_BAD_ARGS),
+          "rate refuses a number with junk after it");
+
+    //
+    // The longest line fits; one more character throws the line away, even
+    // if it is then backspaced over, and the next line is fine.
+    //
+    memset(pcLine, 0, sizeof(pcLine));
+    strcpy(pcLine, "echo ");
+    memset(pcLine + 5, 'x', CONSOLE_LINE_SIZE - 1 - 5);
+    strcat(pcLine, "\r");
+    CHECK((Feed(pcLine, piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_OK) &&
+          (strlen(g_pcArgs) == CONSOLE_LINE_SIZE - 1),
+          "the longest line runs");
+    pcLine[CONSOLE_LINE_SIZE - 1] = 'y';
+    strcpy(pcLine + CONSOLE_LINE_SIZE, "\b\r");
+    CHECK((Feed(pcLine, piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_TOO_LONG) && (g_ui32Runs == 0),
+          "an overlong line is thrown away");
+    CHECK((Feed("echo ok\r", piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_OK) && (strcmp(g_pcArgs, "echo,ok") == 0),
+          "the line after an overlong one runs");
+
+    //
+    // Unknown commands, including prefixes and longer names of known ones,
+    // are reported and run nothing.
+    //
+    CHECK((Feed("bogus 1\r", piResults, 4) == 1) &&
+          (piResults[0] == CONSOLE_BAD_CMD) && (g_ui32Runs == 0),
+          "an unknown command is reported");
+    CHECK((Feed("rat 1\rrates 1\rRATE 1\r", piResults, 4) == 3) &&
+          (piResults[0] == CONSOLE_BAD_CMD) &&
+          (piResults[1] == CONSOLE_BAD_CMD) &&
+          (piResults[2] == CONSOLE_BAD_CMD) && (g_ui32Runs == 0),
+          "command names match whole and case sensitive");
+
+    //
+    // The number parser on its own.
+    //
+    CHECK(ConsoleNumber("4294967295", &ui32Value) &&
+          (ui32Value == 4294967295u), "the largest number parses");
+    CHECK(!ConsoleNumber("", &ui32Value) && !ConsoleNumber("-1", &ui32Value),
+          "empty and negative numbers are refused");
+
+    return(CHECK_SUMMARY());
+}
@@ -0,0 +1,41 @@
+//*****************************************************************************
+//
+// FreeRTOS.h - Host stand-in for the kernel, for the host programs in tools/
+// that build firmware sources as they are.
+//
+// The headers in this directory declare just the FreeRTOS V7 and TivaWare
+// API those sources use, with the target's types; each program defines the
+// calls it needs. Put this directory ahead of the repository root on the
+// include path (-Ihost -I..).
+//
+//*****************************************************************************
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define portCHAR                   char
+#define portBASE_TYPE              long
+#define portSTACK_TYPE             uint32_t
+typedef uint32_t portTickType;
+
+#include "FreeRTOSConfig.h"
+
+#define pdFALSE                    0
+#define pdTRUE                     1
+#define pdFAIL                     pdFALSE
+#define pdPASS                     pdTRUE
+#define portMAX_DELAY              ((portTickType)0xffffffff)
+#define portTICK_RATE_MS           ((portTickType)1000 / configTICK_RATE_HZ)
+#define portEND_SWITCHING_ISR(x)   ((void)(x))
+
+// The programs are single threaded, so a critical section has nothing to
+// keep out.
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+extern size_t xPortGetFreeHeapSize(void);
+
+#endif // INC_FREERTOS_H
@@ -0,0 +1,5 @@
+//*****************************************************************************
+//
+// gpio.h - Host stand-in; nothing from it is used. See FreeRTOS.h.
+//
+//*****************************************************************************
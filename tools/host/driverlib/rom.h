@@ -0,0 +1,5 @@
+//*****************************************************************************
+//
+// rom.h - Host stand-in; nothing from it is used. See FreeRTOS.h.
+//
+//*****************************************************************************
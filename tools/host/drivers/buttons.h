@@ -0,0 +1,13 @@
+//*****************************************************************************
+//
+// buttons.h - Host stand-in for the LaunchPad buttons; see FreeRTOS.h.
+//
+//*****************************************************************************
+
+#ifndef __BUTTONS_H__
+#define __BUTTONS_H__
+
+#define LEFT_BUTTON                0x10    // GPIO_PIN_4
+#define RIGHT_BUTTON               0x01    // GPIO_PIN_0
+
+#endif // __BUTTONS_H__
@@ -0,0 +1,5 @@
+//*****************************************************************************
+//
+// hw_memmap.h - Host stand-in; nothing from it is used. See FreeRTOS.h.
+//
+//*****************************************************************************
@@ -0,0 +1,21 @@
+//*****************************************************************************
+//
+// queue.h - Host stand-in for the FreeRTOS queue API; see FreeRTOS.h.
+//
+//*****************************************************************************
+
+#ifndef INC_QUEUE_H
+#define INC_QUEUE_H
+
+typedef void *xQueueHandle;
+
+extern xQueueHandle xQueueCreate(unsigned portBASE_TYPE uxQueueLength,
+                                 unsigned portBASE_TYPE uxItemSize);
+extern signed portBASE_TYPE
+xQueueReceive(xQueueHandle xQueue, void *pvBuffer, portTickType xTicksToWait);
+extern signed portBASE_TYPE
+xQueueSendToBackFromISR(xQueueHandle xQueue, const void *pvItemToQueue,
+                        signed portBASE_TYPE *pxHigherPriorityTaskWoken);
+extern unsigned portBASE_TYPE uxQueueMessagesWaiting(xQueueHandle xQueue);
+
+#endif // INC_QUEUE_H
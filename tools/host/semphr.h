@@ -0,0 +1,20 @@
+//*****************************************************************************
+//
+// semphr.h - Host stand-in for the FreeRTOS semaphore API; see FreeRTOS.h.
+//
+//*****************************************************************************
+
+#ifndef INC_SEMPHR_H
+#define INC_SEMPHR_H
+
+#include "queue.h"
+
+typedef xQueueHandle xSemaphoreHandle;
+
+#define vSemaphoreCreateBinary(xSemaphore)                                  \
+    ((xSemaphore) = xQueueCreate(1, 0))
+extern signed portBASE_TYPE xSemaphoreTake(xSemaphoreHandle xSemaphore,
+                                           portTickType xBlockTime);
+extern signed portBASE_TYPE xSemaphoreGive(xSemaphoreHandle xSemaphore);
+
+#endif // INC_SEMPHR_H
@@ -0,0 +1,30 @@
+//*****************************************************************************
+//
+// task.h - Host stand-in for the FreeRTOS task API; see FreeRTOS.h.
+//
+//*****************************************************************************
+
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#define tskIDLE_PRIORITY           0
+
+typedef void *xTaskHandle;
+typedef void (*pdTASK_CODE)(void *pvParameters);
+typedef struct xMEMORY_REGION xMemoryRegion;
+
+extern signed portBASE_TYPE
+xTaskGenericCreate(pdTASK_CODE pxTaskCode, const signed char *pcName,
+                   unsigned short usStackDepth, void *pvParameters,
+                   unsigned portBASE_TYPE uxPriority,
+                   xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer,
+                   const xMemoryRegion *xRegions);
+#define xTaskCreate(pvTaskCode, pcName, usStackDepth, pvParameters,         \
+                    uxPriority, pxCreatedTask)                              \
+    xTaskGenericCreate((pvTaskCode), (pcName), (usStackDepth),              \
+                       (pvParameters), (uxPriority), (pxCreatedTask), NULL, \
+                       NULL)
+extern portTickType xTaskGetTickCount(void);
+extern void vTaskDelay(portTickType xTicksToDelay);
+
+#endif // INC_TASK_H
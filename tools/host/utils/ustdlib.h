@@ -0,0 +1,20 @@
+//*****************************************************************************
+//
+// ustdlib.h - Host stand-in for the TivaWare string functions, which are the
+// C library's; see FreeRTOS.h.
+//
+//*****************************************************************************
+
+#ifndef __USTDLIB_H__
+#define __USTDLIB_H__
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define usnprintf                  snprintf
+#define uvsnprintf                 vsnprintf
+#define ustrlen                    strlen
+#define ustrncmp                   strncmp
+
+#endif // __USTDLIB_H__
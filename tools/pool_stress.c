@@ -0,0 +1,369 @@
+//*****************************************************************************
+//
+// pool_stress.c - Host stress test of the block pool.
+//
+// Runs pool.c, with atomic.c on its __sync compare-and-swap path, from
+// several threads at once: each one takes and gives back blocks at random,
+// stamping the blocks it owns and checking the stamps before it gives them
+// back, so a block handed to two owners, or a free list corrupted by a lost
+// update, shows. pool.c is built into this program with its
+// compare-and-swaps made through a wrapper that often yields first, so
+// another thread gets in between the read of the free list head and the
+// swap, as an interrupt would on the target, even on a single CPU. The
+// statistics are then checked: nothing left in use, the refused
+// allocations all counted, and the high-water mark exact when the threads
+// hold every block at once. The exit status is non-zero if any check
+// fails.
+//
+// Build and run on the host:
+//
+//   cc -std=gnu99 -pthread -I.. -o pool_stress pool_stress.c ../atomic.c
+//   ./pool_stress
+//
+//*****************************************************************************
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "check.h"
+#include "atomic.h"
+
+//*****************************************************************************
+//
+// The compare-and-swap pool.c makes: one time in four the thread yields
+// before the real one. Each thread seeds its own choice of when.
+//
+//*****************************************************************************
+static __thread uint32_t g_ui32YieldSeed;
+
+static bool
+StressCompareAndSwap(volatile uint32_t *pui32Addr, uint32_t ui32Old,
+                     uint32_t ui32New)
+{
+    g_ui32YieldSeed = (g_ui32YieldSeed * 1103515245) + 12345;
+    if(((g_ui32YieldSeed >> 16) & 3) == 0)
+    {
+        sched_yield();
+    }
+    return(AtomicCompareAndSwap(pui32Addr, ui32Old, ui32New));
+}
+
+#define AtomicCompareAndSwap StressCompareAndSwap
+#include "pool.c"
+#undef AtomicCompareAndSwap
+
+//*****************************************************************************
+//
+// The threads, the operations each makes, and the most blocks each holds.
+// Together they can hold more blocks than the pool has, so some
+// allocations are refused.
+//
+//*****************************************************************************
+#define NUM_THREADS                4
+#define NUM_OPERATIONS             200000
+#define MAX_HELD                   6
+#define NUM_SHARE_ROUNDS           500
+
+//*****************************************************************************
+//
+// What each thread did, and saw go wrong.
+//
+//*****************************************************************************
+typedef struct
+{
+    pthread_t sThread;
+    uint32_t ui32Id;
+    uint32_t ui32Seed;
+    uint32_t ui32Allocs;
+    uint32_t ui32Refused;
+    uint32_t ui32Shared;                // blocks found stamped by another
+    uint32_t ui32MostHeld;
+}
+tWorker;
+
+static tWorker g_psWorkers[NUM_THREADS];
+static pthread_barrier_t g_sBarrier;
+
+//*****************************************************************************
+//
+// A small per-thread random number generator (xorshift32).
+//
+//*****************************************************************************
+static uint32_t
+Random(tWorker *psWorker)
+{
+    uint32_t x = psWorker->ui32Seed;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    psWorker->ui32Seed = x;
+    return(x);
+}
+
+//*****************************************************************************
+//
+// Stamps every word of a block with its owner and a sequence number, and
+// checks the stamp is still intact. Another owner writing the block at the
+// same time spoils it.
+//
+//*****************************************************************************
+static void
+Stamp(uint32_t *pui32Block, uint32_t ui32Stamp)
+{
+    uint32_t i;
+
+    for(i = 0; i < (POOL_BLOCK_SIZE / 4); i++)
+    {
+        pui32Block[i] = ui32Stamp;
+    }
+}
+
+static bool
+Stamped(const uint32_t *pui32Block, uint32_t ui32Stamp)
+{
+    uint32_t i;
+
+    for(i = 0; i < (POOL_BLOCK_SIZE / 4); i++)
+    {
+        if(pui32Block[i] != ui32Stamp)
+        {
+            return(false);
+        }
+    }
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Takes and gives back blocks at random, yielding now and then so the
+// threads interleave even on one CPU.
+//
+//*****************************************************************************
+static void *
+Worker(void *pvWorker)
+{
+    tWorker *psWorker = pvWorker;
+    uint32_t *ppui32Held[MAX_HELD], pui32Stamp[MAX_HELD];
+    uint32_t ui32Held = 0, ui32Op, ui32Rand, i;
+
+    g_ui32YieldSeed = psWorker->ui32Seed;
+    pthread_barrier_wait(&g_sBarrier);
+
+    for(ui32Op = 0; ui32Op < NUM_OPERATIONS; ui32Op++)
+    {
+        ui32Rand = Random(psWorker);
+        if((ui32Held < MAX_HELD) && ((ui32Held == 0) || (ui32Rand & 1)))
+        {
+            ppui32Held[ui32Held] = PoolAlloc();
+            if(ppui32Held[ui32Held] == 0)
+            {
+                psWorker->ui32Refused++;
+            }
+            else
+            {
+                psWorker->ui32Allocs++;
+                pui32Stamp[ui32Held] = (psWorker->ui32Id << 24) |
+                                       (ui32Op & 0xFFFFFF);
+                Stamp(ppui32Held[ui32Held], pui32Stamp[ui32Held]);
+                ui32Held++;
+                if(ui32Held > psWorker->ui32MostHeld)
+                {
+                    psWorker->ui32MostHeld = ui32Held;
+                }
+            }
+        }
+        else
+        {
+            i = (ui32Rand >> 1) % ui32Held;
+            if(!Stamped(ppui32Held[i], pui32Stamp[i]))
+            {
+                psWorker->ui32Shared++;
+            }
+            PoolFree(ppui32Held[i]);
+            ui32Held--;
+            ppui32Held[i] = ppui32Held[ui32Held];
+            pui32Stamp[i] = pui32Stamp[ui32Held];
+        }
+
+        if((ui32Rand & 0x700) == 0)
+        {
+            sched_yield();
+        }
+    }
+
+    while(ui32Held)
+    {
+        ui32Held--;
+        if(!Stamped(ppui32Held[ui32Held], pui32Stamp[ui32Held]))
+        {
+            psWorker->ui32Shared++;
+        }
+        PoolFree(ppui32Held[ui32Held]);
+    }
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Each thread takes an equal share of the pool, waits until all have, and
+// gives its share back.
+//
+//*****************************************************************************
+static void *
+Filler(void *pvWorker)
+{
+    tWorker *psWorker = pvWorker;
+    void *ppvHeld[POOL_BLOCK_COUNT / NUM_THREADS];
+    uint32_t i;
+
+    g_ui32YieldSeed = psWorker->ui32Seed;
+    pthread_barrier_wait(&g_sBarrier);
+    for(i = 0; i < (POOL_BLOCK_COUNT / NUM_THREADS); i++)
+    {
+        ppvHeld[i] = PoolAlloc();
+        if(ppvHeld[i])
+        {
+            psWorker->ui32Allocs++;
+        }
+        sched_yield();
+    }
+    pthread_barrier_wait(&g_sBarrier);
+    for(i = 0; i < (POOL_BLOCK_COUNT / NUM_THREADS); i++)
+    {
+        PoolFree(ppvHeld[i]);
+        sched_yield();
+    }
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Runs pfnThread on every worker and waits for them all. Every thread of
+// every run gets a different seed.
+//
+//*****************************************************************************
+static void
+RunThreads(void *(*pfnThread)(void *))
+{
+    static uint32_t ui32Runs;
+    uint32_t i;
+
+    memset(g_psWorkers, 0, sizeof(g_psWorkers));
+    for(i = 0; i < NUM_THREADS; i++)
+    {
+        g_psWorkers[i].ui32Id = i + 1;
+        g_psWorkers[i].ui32Seed = 0x9E3779B9 * ((ui32Runs * NUM_THREADS) +
+                                                i + 1);
+        pthread_create(&g_psWorkers[i].sThread, 0, pfnThread,
+                       &g_psWorkers[i]);
+    }
+    ui32Runs++;
+    for(i = 0; i < NUM_THREADS; i++)
+    {
+        pthread_join(g_psWorkers[i].sThread, 0);
+    }
+}
+
+//*****************************************************************************
+//
+// Takes every block there is, from one thread, and checks they are all
+// different. Returns the number taken; the blocks are given back.
+//
+//*****************************************************************************
+static uint32_t
+Drain(void)
+{
+    void *ppvBlocks[POOL_BLOCK_COUNT + 1];
+    uint32_t ui32Count, i, j;
+    bool bDistinct = true;
+
+    for(ui32Count = 0; ui32Count <= POOL_BLOCK_COUNT; ui32Count++)
+    {
+        ppvBlocks[ui32Count] = PoolAlloc();
+        if(ppvBlocks[ui32Count] == 0)
+        {
+            break;
+        }
+        for(j = 0; j < ui32Count; j++)
+        {
+            bDistinct = bDistinct && (ppvBlocks[j] != ppvBlocks[ui32Count]);
+        }
+    }
+    CHECK(bDistinct, "every block handed out once");
+    for(i = 0; i < ui32Count; i++)
+    {
+        PoolFree(ppvBlocks[i]);
+    }
+    return(ui32Count);
+}
+
+int
+main(void)
+{
+    uint32_t ui32Allocs, ui32Refused, ui32Shared, ui32MostHeld, i;
+    uint32_t ui32Round, ui32Short, ui32Wrong;
+
+    pthread_barrier_init(&g_sBarrier, 0, NUM_THREADS);
+
+    //
+    // One thread: the whole pool, then one refusal.
+    //
+    PoolInit();
+    CHECK(Drain() == POOL_BLOCK_COUNT, "the pool holds every block");
+    CHECK((PoolInUse() == 0) && (PoolHighWater() == POOL_BLOCK_COUNT) &&
+          (PoolFailed() == 1), "statistics after draining the pool");
+
+    //
+    // Every thread holds its share of the pool at once, so the high-water
+    // mark must reach exactly the pool size however the updates race.
+    //
+    ui32Short = ui32Wrong = 0;
+    for(ui32Round = 0; ui32Round < NUM_SHARE_ROUNDS; ui32Round++)
+    {
+        PoolInit();
+        RunThreads(Filler);
+        for(ui32Allocs = 0, i = 0; i < NUM_THREADS; i++)
+        {
+            ui32Allocs += g_psWorkers[i].ui32Allocs;
+        }
+        ui32Short += (ui32Allocs != POOL_BLOCK_COUNT);
+        ui32Wrong += ((PoolHighWater() != POOL_BLOCK_COUNT) ||
+                      (PoolInUse() != 0) || (PoolFailed() != 0));
+    }
+    CHECK(ui32Short == 0, "every share allocated");
+    CHECK(ui32Wrong == 0, "statistics with the pool shared out");
+
+    //
+    // Random allocations and frees from every thread.
+    //
+    PoolInit();
+    RunThreads(Worker);
+    ui32Allocs = ui32Refused = ui32Shared = ui32MostHeld = 0;
+    for(i = 0; i < NUM_THREADS; i++)
+    {
+        ui32Allocs += g_psWorkers[i].ui32Allocs;
+        ui32Refused += g_psWorkers[i].ui32Refused;
+        ui32Shared += g_psWorkers[i].ui32Shared;
+        if(g_psWorkers[i].ui32MostHeld > ui32MostHeld)
+        {
+            ui32MostHeld = g_psWorkers[i].ui32MostHeld;
+        }
+    }
+    printf("%u allocations, %u refused, high-water mark %u\n", ui32Allocs,
+           ui32Refused, PoolHighWater());
+    CHECK(ui32Shared == 0, "no block owned twice");
+    CHECK(PoolInUse() == 0, "nothing in use after the threads finish");
+    CHECK(PoolFailed() == ui32Refused, "every refusal counted");
+    CHECK((PoolHighWater() >= ui32MostHeld) &&
+          (PoolHighWater() <= POOL_BLOCK_COUNT),
+          "high-water mark within bounds");
+    CHECK(Drain() == POOL_BLOCK_COUNT, "free list intact afterwards");
+
+    pthread_barrier_destroy(&g_sBarrier);
+
+    return(CHECK_SUMMARY());
+}
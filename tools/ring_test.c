@@ -0,0 +1,274 @@
+//*****************************************************************************
+//
+// ring_test.c - Host test of the single-producer, single-consumer ring.
+//
+// Checks ring.c first from one thread (empty and full rings, and spans
+// that stop at the end of the buffer), then with a producer thread and a
+// consumer thread running at once, as an interrupt handler and a task do
+// on the target. The producer writes items numbered in sequence, in
+// batches of random size through the span calls and one at a time through
+// RingWrite(); the consumer reads them back the same two ways and checks
+// that every number arrives once, in order, with its item intact. The exit
+// status is non-zero if any check fails.
+//
+// atomic.c supplies the ring's barriers: a C11 fence when built as C11, as
+// below, or the __sync builtin when built as C99 (-std=gnu99). Run both.
+//
+// Build and run on the host:
+//
+//   cc -std=gnu11 -pthread -I.. -o ring_test ring_test.c ../ring.c
+//      ../atomic.c
+//   ./ring_test
+//
+//*****************************************************************************
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "check.h"
+#include "ring.h"
+
+//*****************************************************************************
+//
+// The ring under test: a few items, so it fills and empties often, each
+// larger than a word, so a half-written item shows.
+//
+//*****************************************************************************
+#define RING_ITEMS                 16
+#define NUM_TRANSFERS              2000000
+
+typedef struct
+{
+    uint32_t ui32Sequence;
+    uint32_t ui32Check;             // ~ui32Sequence
+}
+tItem;
+
+static tItem g_psItems[RING_ITEMS];
+static tRing g_sRing;
+
+//*****************************************************************************
+//
+// A small random number generator (xorshift32), one per thread.
+//
+//*****************************************************************************
+static uint32_t
+Random(uint32_t *pui32Seed)
+{
+    uint32_t x = *pui32Seed;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pui32Seed = x;
+    return(x);
+}
+
+//*****************************************************************************
+//
+// What the producer and the consumer saw: how often the ring was full or
+// empty, which shows they really overlapped, and the first item that came
+// out wrong.
+//
+//*****************************************************************************
+static uint32_t g_ui32Full;
+static uint32_t g_ui32Empty;
+static uint32_t g_ui32Received;
+static uint32_t g_ui32Errors;
+static uint32_t g_ui32FirstBad;
+
+//*****************************************************************************
+//
+// The producer: every fourth time one item with RingWrite(), otherwise a
+// batch of one to eight items through the span, yielding now and then.
+//
+//*****************************************************************************
+static void *
+Producer(void *pvArg)
+{
+    uint32_t ui32Seed = 0x12345678, ui32Next = 0, ui32Rand, ui32Span, i;
+    tItem *psSpan, sItem;
+
+    (void)pvArg;
+    while(ui32Next < NUM_TRANSFERS)
+    {
+        ui32Rand = Random(&ui32Seed);
+        if((ui32Rand & 3) == 0)
+        {
+            sItem.ui32Sequence = ui32Next;
+            sItem.ui32Check = ~ui32Next;
+            if(RingWrite(&g_sRing, &sItem))
+            {
+                ui32Next++;
+            }
+            else
+            {
+                g_ui32Full++;
+                sched_yield();
+            }
+            continue;
+        }
+
+        ui32Span = RingWriteSpan(&g_sRing, (void **)&psSpan);
+        if(ui32Span == 0)
+        {
+            g_ui32Full++;
+            sched_yield();
+            continue;
+        }
+        if(ui32Span > (((ui32Rand >> 2) & 7) + 1))
+        {
+            ui32Span = ((ui32Rand >> 2) & 7) + 1;
+        }
+        if(ui32Span > (NUM_TRANSFERS - ui32Next))
+        {
+            ui32Span = NUM_TRANSFERS - ui32Next;
+        }
+        for(i = 0; i < ui32Span; i++)
+        {
+            psSpan[i].ui32Sequence = ui32Next + i;
+            psSpan[i].ui32Check = ~(ui32Next + i);
+        }
+        if((ui32Rand & 0x3E0) == 0)
+        {
+            sched_yield();
+        }
+        RingWriteCommit(&g_sRing, ui32Span);
+        ui32Next += ui32Span;
+    }
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Checks one received item against the number expected next.
+//
+//*****************************************************************************
+static void
+Receive(const tItem *psItem)
+{
+    if(((psItem->ui32Sequence != g_ui32Received) ||
+        (psItem->ui32Check != ~g_ui32Received)) && (g_ui32Errors++ == 0))
+    {
+        g_ui32FirstBad = g_ui32Received;
+    }
+    g_ui32Received++;
+}
+
+//*****************************************************************************
+//
+// The consumer, in this thread: one item with RingRead() or part of a span,
+// at random, yielding now and then.
+//
+//*****************************************************************************
+static void
+Consumer(void)
+{
+    uint32_t ui32Seed = 0x87654321, ui32Rand, ui32Span, i;
+    tItem *psSpan, sItem;
+
+    while(g_ui32Received < NUM_TRANSFERS)
+    {
+        ui32Rand = Random(&ui32Seed);
+        if((ui32Rand & 3) == 0)
+        {
+            if(RingRead(&g_sRing, &sItem))
+            {
+                Receive(&sItem);
+            }
+            else
+            {
+                g_ui32Empty++;
+                sched_yield();
+            }
+            continue;
+        }
+
+        ui32Span = RingReadSpan(&g_sRing, (void **)&psSpan);
+        if(ui32Span == 0)
+        {
+            g_ui32Empty++;
+            sched_yield();
+            continue;
+        }
+        if(ui32Span > (((ui32Rand >> 2) & 7) + 1))
+        {
+            ui32Span = ((ui32Rand >> 2) & 7) + 1;
+        }
+        for(i = 0; i < ui32Span; i++)
+        {
+            Receive(&psSpan[i]);
+        }
+        if((ui32Rand & 0x3E0) == 0)
+        {
+            sched_yield();
+        }
+        RingReadCommit(&g_sRing, ui32Span);
+    }
+}
+
+int
+main(void)
+{
+    pthread_t sProducer;
+    tItem sItem, *psSpan;
+    uint32_t i;
+    bool bOk;
+
+    //
+    // One thread: empty, full, and a span that stops at the end of the
+    // buffer with the rest of the batch at the start.
+    //
+    RingInit(&g_sRing, g_psItems, sizeof(tItem), RING_ITEMS);
+    CHECK(!RingRead(&g_sRing, &sItem) &&
+          (RingReadSpan(&g_sRing, (void **)&psSpan) == 0),
+          "a new ring is empty");
+    for(i = 0, bOk = true; i < RING_ITEMS; i++)
+    {
+        sItem.ui32Sequence = i;
+        bOk = bOk && RingWrite(&g_sRing, &sItem);
+    }
+    CHECK(bOk && (RingUsed(&g_sRing) == RING_ITEMS), "the ring fills");
+    CHECK(!RingWrite(&g_sRing, &sItem) &&
+          (RingWriteSpan(&g_sRing, (void **)&psSpan) == 0),
+          "a full ring refuses more");
+    for(i = 0; i < (RING_ITEMS - 3); i++)
+    {
+        RingRead(&g_sRing, &sItem);
+    }
+    CHECK((sItem.ui32Sequence == (RING_ITEMS - 4)) &&
+          (RingUsed(&g_sRing) == 3), "items come out in order");
+    CHECK((RingWriteSpan(&g_sRing, (void **)&psSpan) == (RING_ITEMS - 3)) &&
+          (psSpan == &g_psItems[0]), "the free span starts at the front");
+    RingWriteCommit(&g_sRing, 5);
+    CHECK((RingReadSpan(&g_sRing, (void **)&psSpan) == 3) &&
+          (psSpan == &g_psItems[RING_ITEMS - 3]),
+          "the waiting span stops at the end");
+    RingReadCommit(&g_sRing, 3);
+    CHECK((RingReadSpan(&g_sRing, (void **)&psSpan) == 5) &&
+          (psSpan == &g_psItems[0]), "the rest is at the front");
+
+    //
+    // A producer thread and a consumer thread.
+    //
+    RingInit(&g_sRing, g_psItems, sizeof(tItem), RING_ITEMS);
+    pthread_create(&sProducer, 0, Producer, 0);
+    Consumer();
+    pthread_join(sProducer, 0);
+
+    printf("%u items, ring full %u times, empty %u times\n", g_ui32Received,
+           g_ui32Full, g_ui32Empty);
+    if(g_ui32Errors)
+    {
+        printf("%u items wrong, the first number %u\n", g_ui32Errors,
+               g_ui32FirstBad);
+    }
+    CHECK(g_ui32Errors == 0, "every item once, in order and intact");
+    CHECK((g_ui32Full != 0) && (g_ui32Empty != 0),
+          "the threads overlapped");
+    CHECK(RingUsed(&g_sRing) == 0, "nothing left over");
+
+    return(CHECK_SUMMARY());
+}
@@ -0,0 +1,285 @@
+//*****************************************************************************
+//
+// schedule_test.c - Host check of the Sensor task's sampling schedules.
+//
+// Runs the deadline arithmetic of schedule.c, which the Sensor task uses,
+// against a simulated task and simulated drivers, and checks the rate each
+// sensor achieves with the same test the rate report applies on the
+// target: software-paced sensors at periods that are not whole ticks, with
+// scheduling jitter, a stalled task and a wrapping tick count, and
+// hardware-paced sensors across the accelerometer's 10 Hz to 10 kHz range,
+// on time and with a block lost. The exit status is non-zero if any check
+// fails.
+//
+// Build and run on the host:
+//
+//   cc -std=gnu99 -I.. -o schedule_test schedule_test.c ../schedule.c
+//   ./schedule_test
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "check.h"
+#include "schedule.h"
+
+//*****************************************************************************
+//
+// The firmware's tick, 1 ms (configTICK_RATE_HZ).
+//
+//*****************************************************************************
+#define TICK_US                    1000
+
+//*****************************************************************************
+//
+// Runs a software-paced sensor for ui32Ms from tick ui32Start, as the
+// Sensor task would: it sleeps until the deadline, wakes up to
+// ui32Jitter ticks late, reads a batch and sets the next deadline. From
+// ui32StallAt the task is held off for ui32StallMs. Returns the samples
+// read.
+//
+//*****************************************************************************
+static uint32_t
+RunSoftware(tSchedule *psSchedule, uint32_t ui32Start, uint32_t ui32Ms,
+            uint32_t ui32Jitter, uint32_t ui32StallAt, uint32_t ui32StallMs)
+{
+    uint32_t ui32Now, ui32Samples = 0;
+    int32_t i32Wait;
+
+    ui32Now = ui32Start;
+    ScheduleRestart(psSchedule, ui32Now);
+    while(1)
+    {
+        i32Wait = ScheduleWait(psSchedule, ui32Now);
+        if(i32Wait > 0)
+        {
+            ui32Now += i32Wait;
+        }
+        if(ui32Jitter)
+        {
+            ui32Now += rand() % (ui32Jitter + 1);
+        }
+        if(ui32StallMs && ((ui32Now - ui32Start) >= ui32StallAt))
+        {
+            ui32Now += ui32StallMs;
+            ui32StallMs = 0;
+        }
+        if((ui32Now - ui32Start) >= ui32Ms)
+        {
+            return(ui32Samples);
+        }
+        ui32Samples += psSchedule->ui32Batch;
+        ScheduleNext(psSchedule, ui32Now);
+        if(ScheduleWait(psSchedule, ui32Now) < 0)
+        {
+            return(0);                  // left overdue, it would spin
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Runs a hardware-paced sensor for ui32Ms. The driver fills a block every
+// ui32Batch periods, exactly, and the task sees it up to ui32Latency ticks
+// later; block ui32Lost never arrives. A deadline that passes before the
+// next block is a miss, and the task sets the next deadline from it, as it
+// does when a block is late. Returns the misses; the samples delivered are
+// added to *pui32Samples.
+//
+//*****************************************************************************
+static uint32_t
+RunHardware(tSchedule *psSchedule, uint32_t ui32Ms, uint32_t ui32Latency,
+            uint32_t ui32Lost, uint32_t *pui32Samples)
+{
+    uint64_t ui64BlockUs, ui64Due;
+    uint32_t ui32Block, ui32Arrival, ui32Missed = 0;
+
+    *pui32Samples = 0;
+    ScheduleRestart(psSchedule, 0);
+    ui64BlockUs = (uint64_t)psSchedule->ui32PeriodUs * psSchedule->ui32Batch;
+    for(ui32Block = 1; ; ui32Block++)
+    {
+        ui64Due = ui64BlockUs * ui32Block;
+        if(ui64Due >= ((uint64_t)ui32Ms * 1000))
+        {
+            return(ui32Missed);
+        }
+        if(ui32Block == ui32Lost)
+        {
+            continue;
+        }
+        ui32Arrival = (ui64Due / TICK_US) +
+                      (ui32Latency ? (rand() % (ui32Latency + 1)) : 0);
+
+        //
+        // Every deadline that falls before the block is a miss.
+        //
+        while(ScheduleWait(psSchedule, ui32Arrival) < 0)
+        {
+            ui32Missed++;
+            ScheduleNext(psSchedule, psSchedule->ui32Deadline);
+        }
+        *pui32Samples += psSchedule->ui32Batch;
+        ScheduleNext(psSchedule, ui32Arrival);
+    }
+}
+
+//*****************************************************************************
+//
+// Software-paced sensors, such as the light sensor, read on the grid.
+//
+//*****************************************************************************
+static void
+CheckSoftware(void)
+{
+    static const uint32_t pui32PeriodUs[] =
+    {
+        100000, 1000000, 60000000, 3333, 1500, 7777, 2000
+    };
+    tSchedule sSchedule;
+    uint32_t ui32Samples, ui32Ms, ui32Jitter, ui32Bad, i;
+
+    //
+    // On time, and with the task up to two ticks late (but never a whole
+    // interval, which no schedule can absorb), the rate holds for periods
+    // that are not a whole number of ticks.
+    //
+    ui32Bad = 0;
+    for(i = 0; i < (sizeof(pui32PeriodUs) / sizeof(pui32PeriodUs[0])); i++)
+    {
+        ui32Ms = (pui32PeriodUs[i] >= 1000000) ? 600000 : 10000;
+        ui32Jitter = pui32PeriodUs[i] / TICK_US;
+        if(ui32Jitter > 2)
+        {
+            ui32Jitter = 2;
+        }
+        ScheduleInit(&sSchedule, pui32PeriodUs[i], 1, false, TICK_US);
+        ui32Samples = RunSoftware(&sSchedule, 0, ui32Ms, 0, 0, 0);
+        if(!ScheduleRateOk(&sSchedule, ui32Samples, ui32Ms))
+        {
+            printf("  %u us: %u samples in %u ms\n", pui32PeriodUs[i],
+                   ui32Samples, ui32Ms);
+            ui32Bad++;
+        }
+        ui32Samples = RunSoftware(&sSchedule, 0, ui32Ms, ui32Jitter, 0, 0);
+        if(!ScheduleRateOk(&sSchedule, ui32Samples, ui32Ms))
+        {
+            printf("  %u us with jitter: %u samples in %u ms\n",
+                   pui32PeriodUs[i], ui32Samples, ui32Ms);
+            ui32Bad++;
+        }
+    }
+    CHECK(ui32Bad == 0, "software-paced rates");
+
+    //
+    // 300 Hz is 3.33 ticks; truncating each interval would give 333 Hz.
+    //
+    ScheduleInit(&sSchedule, 1000000 / 300, 1, false, TICK_US);
+    ui32Samples = RunSoftware(&sSchedule, 0, 10000, 0, 0, 0);
+    CHECK((ui32Samples >= 2998) && (ui32Samples <= 3000), "no drift at 300 Hz");
+
+    //
+    // Batched reads keep the grid too.
+    //
+    ScheduleInit(&sSchedule, 1500, 4, false, TICK_US);
+    ui32Samples = RunSoftware(&sSchedule, 0, 6000, 1, 0, 0);
+    CHECK(ScheduleRateOk(&sSchedule, ui32Samples, 6000), "batched reads");
+
+    //
+    // The tick count wraps in the middle of the run.
+    //
+    ScheduleInit(&sSchedule, 100000, 1, false, TICK_US);
+    ui32Samples = RunSoftware(&sSchedule, 0xFFFFFFFF - 5000, 20000, 1, 0, 0);
+    CHECK(ScheduleRateOk(&sSchedule, ui32Samples, 20000), "tick count wrap");
+
+    //
+    // A task held off for ten periods does not catch up with a burst of
+    // back-to-back reads, and the report sees the shortfall.
+    //
+    ScheduleInit(&sSchedule, 100000, 1, false, TICK_US);
+    ui32Samples = RunSoftware(&sSchedule, 0, 10000, 0, 3000, 1000);
+    CHECK((ui32Samples > 0) && (ui32Samples <= 91), "no burst after a stall");
+    CHECK(!ScheduleRateOk(&sSchedule, ui32Samples, 10000),
+          "stall fails the rate check");
+}
+
+//*****************************************************************************
+//
+// Hardware-paced sensors, such as the accelerometer, across its range.
+//
+//*****************************************************************************
+static void
+CheckHardware(void)
+{
+    static const uint32_t pui32Hz[] = { 10, 100, 300, 1000, 3333, 10000 };
+    tSchedule sSchedule;
+    uint32_t ui32Samples, ui32Missed, ui32Bad, ui32PeriodUs, i;
+
+    ui32Bad = 0;
+    for(i = 0; i < (sizeof(pui32Hz) / sizeof(pui32Hz[0])); i++)
+    {
+        ui32PeriodUs = 1000000 / pui32Hz[i];
+        ScheduleInit(&sSchedule, ui32PeriodUs, 16, true, TICK_US);
+
+        //
+        // Blocks a tick late are not misses.
+        //
+        ui32Missed = RunHardware(&sSchedule, 60000, 1, 0, &ui32Samples);
+        if((ui32Missed != 0) ||
+           !ScheduleRateOk(&sSchedule, ui32Samples, 60000))
+        {
+            printf("  %u Hz: %u samples, %u missed\n", pui32Hz[i],
+                   ui32Samples, ui32Missed);
+            ui32Bad++;
+        }
+
+        //
+        // A lost block is at most one miss. Once a block takes longer than
+        // the latency allowance it is exactly one; above that rate only
+        // the sample count shows it.
+        //
+        ui32Missed = RunHardware(&sSchedule, 60000, 0, 5, &ui32Samples);
+        if((ui32Missed > 1) ||
+           ((ui32Missed == 0) && ((16 * ui32PeriodUs) > (2 * TICK_US))))
+        {
+            printf("  %u Hz with a lost block: %u samples, %u missed\n",
+                   pui32Hz[i], ui32Samples, ui32Missed);
+            ui32Bad++;
+        }
+    }
+    CHECK(ui32Bad == 0, "hardware-paced rates");
+}
+
+//*****************************************************************************
+//
+// The rate report's arithmetic.
+//
+//*****************************************************************************
+static void
+CheckReport(void)
+{
+    tSchedule sSchedule;
+
+    ScheduleInit(&sSchedule, 100, 16, true, TICK_US);
+    CHECK(ScheduleExpected(&sSchedule, 3600000) == 36000000,
+          "10 kHz for an hour");
+    CHECK(ScheduleCentiHz(36000000, 3600000) == 1000000,
+          "10 kHz in hundredths of a Hz");
+    CHECK(ScheduleRateOk(&sSchedule, 36000000 - 16, 3600000) &&
+          !ScheduleRateOk(&sSchedule, 36000000 - 17, 3600000) &&
+          !ScheduleRateOk(&sSchedule, 36000000 + 17, 3600000),
+          "within one batch");
+    CHECK(ScheduleCentiHz(3, 10000) == 30, "0.3 Hz");
+}
+
+int
+main(void)
+{
+    srand(1);
+    CheckSoftware();
+    CheckHardware();
+    CheckReport();
+    return(CHECK_SUMMARY());
+}
@@ -0,0 +1,387 @@
+//*****************************************************************************
+//
+// telemetry_decode.c - Host decoder for the binary telemetry stream.
+//
+// Turns a capture of the UART output (see telemetry.h) into CSV, one row
+// per sample, on stdout. Deferred log messages are expanded from
+// log_formats.h and printed on stderr. Frames that fail COBS decoding or the CRC, and
+// gaps in a stream's sequence numbers, are counted on stderr; the exit
+// status is non-zero if any frame was bad. Text mixed into the capture is
+// skipped.
+//
+// Build and run on the host:
+//
+//   cc -I.. -o telemetry_decode telemetry_decode.c ../telemetry.c
+//   ./telemetry_decode capture.bin > samples.csv
+//
+// With -g it writes a synthetic capture built with the firmware's own
+// encoder instead, so the format can be round-trip tested without a board:
+//
+//   ./telemetry_decode -g > capture.bin && ./telemetry_decode capture.bin
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "check.h"
+#include "telemetry.h"
+
+//*****************************************************************************
+//
+// The log format strings, indexed by format ID.
+//
+//*****************************************************************************
+#define LOG_FORMAT(id, format)     format,
+static const char *g_ppcLogFormats[] =
+{
+#include "log_formats.h"
+};
+#undef LOG_FORMAT
+#define LOG_FORMAT(id, format)     id,
+enum
+{
+#include "log_formats.h"
+};
+#undef LOG_FORMAT
+#define NUM_LOG_FORMATS            (sizeof(g_ppcLogFormats) /               \
+                                    sizeof(g_ppcLogFormats[0]))
+
+//*****************************************************************************
+//
+// Decoder state.
+//
+//*****************************************************************************
+static uint32_t g_ui32Frames, g_ui32BadFrames, g_ui32Gaps, g_ui32Text;
+static int g_piNextSequence[256];
+
+static uint32_t
+ReadLE(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32Value = 0;
+
+    while(ui32Size--)
+    {
+        ui32Value = (ui32Value << 8) | pui8Data[ui32Size];
+    }
+    return(ui32Value);
+}
+
+//*****************************************************************************
+//
+// Returns true if a block that failed to decode is just text, such as a
+// report the firmware printed between records.
+//
+//*****************************************************************************
+static bool
+IsText(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+    while(ui32Len--)
+    {
+        if(((*pui8Data < ' ') || (*pui8Data > '~')) && (*pui8Data != '\r') &&
+           (*pui8Data != '\n'))
+        {
+            return(false);
+        }
+        pui8Data++;
+    }
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Reads a varint at *pui32Pos, advancing it. Returns false if the record
+// ends first.
+//
+//*****************************************************************************
+static bool
+ReadVarint(const uint8_t *pui8Data, uint32_t ui32Len, uint32_t *pui32Pos,
+           uint32_t *pui32Value)
+{
+    uint32_t ui32Shift = 0;
+
+    *pui32Value = 0;
+    while((*pui32Pos < ui32Len) && (ui32Shift < 35))
+    {
+        *pui32Value |= (uint32_t)(pui8Data[*pui32Pos] & 0x7F) << ui32Shift;
+        if((pui8Data[(*pui32Pos)++] & 0x80) == 0)
+        {
+            return(true);
+        }
+        ui32Shift += 7;
+    }
+    return(false);
+}
+
+//*****************************************************************************
+//
+// Expands a deferred log record, which has already passed its CRC check,
+// the way UARTprintf() would have printed it.
+//
+//*****************************************************************************
+static bool
+ExpandLog(const uint8_t *pui8Record, uint32_t ui32Len)
+{
+    uint32_t ui32Pos = 1, ui32Format, ui32Arg, ui32Args = 0;
+    uint32_t pui32Args[8];
+    const char *pcFormat;
+    char pcSpec[16];
+    uint32_t i;
+
+    if(!ReadVarint(pui8Record, ui32Len, &ui32Pos, &ui32Format) ||
+       (ui32Format >= NUM_LOG_FORMATS))
+    {
+        return(false);
+    }
+    while((ui32Pos < ui32Len) && (ui32Args < 8))
+    {
+        if(!ReadVarint(pui8Record, ui32Len, &ui32Pos, &pui32Args[ui32Args++]))
+        {
+            return(false);
+        }
+    }
+
+    for(pcFormat = g_ppcLogFormats[ui32Format], ui32Arg = 0; *pcFormat;
+        pcFormat++)
+    {
+        if(*pcFormat != '%')
+        {
+            fputc(*pcFormat, stderr);
+            continue;
+        }
+
+        //
+        // Copy the flags and width, then print with the matching host
+        // conversion.
+        //
+        i = 0;
+        pcSpec[i++] = *pcFormat++;
+        while((*pcFormat >= '0') && (*pcFormat <= '9') && (i < 12))
+        {
+            pcSpec[i++] = *pcFormat++;
+        }
+        if(*pcFormat == '%')
+        {
+            fputc('%', stderr);
+            continue;
+        }
+        if(*pcFormat == '\0')
+        {
+            break;
+        }
+        pcSpec[i++] = (*pcFormat == 'i') ? 'd' : *pcFormat;
+        pcSpec[i] = '\0';
+        if(ui32Arg >= ui32Args)
+        {
+            return(false);
+        }
+        if((*pcFormat == 'd') || (*pcFormat == 'i'))
+        {
+            fprintf(stderr, pcSpec, (int)pui32Args[ui32Arg++]);
+        }
+        else
+        {
+            fprintf(stderr, pcSpec, (unsigned int)pui32Args[ui32Arg++]);
+        }
+    }
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Decodes one frame, without its delimiters, and prints its samples.
+//
+//*****************************************************************************
+static void
+DecodeFrame(const uint8_t *pui8Frame, uint32_t ui32Len)
+{
+    uint8_t pui8Record[1024];
+    uint32_t ui32Count, ui32Size, ui32Period, ui32Time, i;
+    int32_t i32Len;
+    uint8_t ui8Type, ui8Sequence;
+    const uint8_t *pui8Sample;
+
+    if(ui32Len > sizeof(pui8Record))
+    {
+        g_ui32BadFrames++;
+        return;
+    }
+    i32Len = TelemetryCOBSDecode(pui8Record, pui8Frame, ui32Len);
+    if((i32Len < (1 + TELEMETRY_CRC_SIZE)) ||
+       (TelemetryCRC16(pui8Record, i32Len - TELEMETRY_CRC_SIZE) !=
+        ReadLE(pui8Record + i32Len - TELEMETRY_CRC_SIZE, TELEMETRY_CRC_SIZE)))
+    {
+        if(IsText(pui8Frame, ui32Len))
+        {
+            g_ui32Text++;
+        }
+        else
+        {
+            g_ui32BadFrames++;
+        }
+        return;
+    }
+
+    ui8Type = pui8Record[0];
+    if(ui8Type == TELEMETRY_TYPE_LOG)
+    {
+        if(ExpandLog(pui8Record, i32Len - TELEMETRY_CRC_SIZE))
+        {
+            g_ui32Frames++;
+        }
+        else
+        {
+            g_ui32BadFrames++;
+        }
+        return;
+    }
+    if(i32Len < (TELEMETRY_HEADER_SIZE + TELEMETRY_CRC_SIZE))
+    {
+        g_ui32BadFrames++;
+        return;
+    }
+    ui8Sequence = pui8Record[1];
+    ui32Count = pui8Record[2];
+    ui32Size = pui8Record[3];
+    ui32Period = ReadLE(pui8Record + 4, 2);
+    ui32Time = ReadLE(pui8Record + 6, 4);
+    if((TELEMETRY_HEADER_SIZE + (ui32Count * ui32Size) + TELEMETRY_CRC_SIZE) !=
+       (uint32_t)i32Len)
+    {
+        g_ui32BadFrames++;
+        return;
+    }
+    g_ui32Frames++;
+
+    if((g_piNextSequence[ui8Type] >= 0) &&
+       (g_piNextSequence[ui8Type] != ui8Sequence))
+    {
+        g_ui32Gaps++;
+    }
+    g_piNextSequence[ui8Type] = (ui8Sequence + 1) & 0xFF;
+
+    for(i = 0; i < ui32Count; i++)
+    {
+        pui8Sample = pui8Record + TELEMETRY_HEADER_SIZE + (i * ui32Size);
+        printf("%s,%u,%u,", (ui8Type == TELEMETRY_TYPE_ACCEL) ? "accel" :
+               (ui8Type == TELEMETRY_TYPE_LIGHT) ? "light" : "unknown",
+               ui8Sequence, ui32Time - ((ui32Count - 1 - i) * ui32Period));
+        if((ui8Type == TELEMETRY_TYPE_ACCEL) && (ui32Size == 6))
+        {
+            printf("%u,%u,%u,\n", ReadLE(pui8Sample, 2),
+                   ReadLE(pui8Sample + 2, 2), ReadLE(pui8Sample + 4, 2));
+        }
+        else if((ui8Type == TELEMETRY_TYPE_LIGHT) && (ui32Size == 4))
+        {
+            printf(",,,%u\n", ReadLE(pui8Sample, 4));
+        }
+        else
+        {
+            printf(",,,\n");
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Writes a synthetic capture: accelerometer ramps at 100 Hz in records of
+// eight samples, a light reading every second, and some text in between
+// the way the firmware's reports land in the stream.
+//
+//*****************************************************************************
+static void
+Generate(void)
+{
+    uint16_t pui16Accel[8 * 3];
+    uint32_t ui32Light;
+    uint8_t pui8Frame[64], ui8AccelSeq = 0, ui8LightSeq = 0;
+    uint32_t ui32Time, ui32Len, i;
+    uint32_t pui32Load[2] = { 3, 0 };
+
+    for(ui32Time = 80; ui32Time <= 10000; ui32Time += 80)
+    {
+        for(i = 0; i < 8 * 3; i++)
+        {
+            pui16Accel[i] = ((ui32Time / 10) - 7 + (i / 3) + (i % 3) * 1000) &
+                            0x0FFF;
+        }
+        ui32Len = TelemetryFrame(pui8Frame, sizeof(pui8Frame),
+                                 TELEMETRY_TYPE_ACCEL, ui8AccelSeq++,
+                                 ui32Time, 10, pui16Accel, 8, 6);
+        fwrite(pui8Frame, 1, ui32Len, stdout);
+
+        if((ui32Time % 1000) < 80)
+        {
+            ui32Light = ui32Time * 3;
+            ui32Len = TelemetryFrame(pui8Frame, sizeof(pui8Frame),
+                                     TELEMETRY_TYPE_LIGHT, ui8LightSeq++,
+                                     ui32Time, 1000, &ui32Light, 1, 4);
+            fwrite(pui8Frame, 1, ui32Len, stdout);
+            printf("Sensor: light\r\n");
+            ui32Len = TelemetryLogFrame(pui8Frame, sizeof(pui8Frame),
+                                        LOG_CPU_LOAD, pui32Load, 2);
+            fwrite(pui8Frame, 1, ui32Len, stdout);
+        }
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    uint8_t pui8Frame[2048];
+    uint32_t ui32Len = 0;
+    FILE *pFile = stdin;
+    int iByte, i;
+
+    if((argc > 1) && (strcmp(argv[1], "-g") == 0))
+    {
+        Generate();
+        return(0);
+    }
+    if(argc > 1)
+    {
+        pFile = fopen(argv[1], "rb");
+        if(pFile == NULL)
+        {
+            perror(argv[1]);
+            return(1);
+        }
+    }
+
+    for(i = 0; i < 256; i++)
+    {
+        g_piNextSequence[i] = -1;
+    }
+
+    //
+    // Every zero byte ends a frame; runs of zeros and overlong frames are
+    // skipped.
+    //
+    printf("stream,sequence,time_ms,x,y,z,light\n");
+    while((iByte = fgetc(pFile)) != EOF)
+    {
+        if(iByte != 0)
+        {
+            if(ui32Len < sizeof(pui8Frame))
+            {
+                pui8Frame[ui32Len] = iByte;
+            }
+            ui32Len++;
+            continue;
+        }
+        if((ui32Len != 0) && (ui32Len <= sizeof(pui8Frame)))
+        {
+            DecodeFrame(pui8Frame, ui32Len);
+        }
+        else if(ui32Len != 0)
+        {
+            g_ui32BadFrames++;
+        }
+        ui32Len = 0;
+    }
+
+    fprintf(stderr, "%u frames, %u bad, %u sequence gaps, %u text blocks\n",
+            g_ui32Frames, g_ui32BadFrames, g_ui32Gaps, g_ui32Text);
+    return(g_ui32BadFrames != 0);
+}
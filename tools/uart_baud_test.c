@@ -0,0 +1,93 @@
+//*****************************************************************************
+//
+// uart_baud_test.c - Host check of the UART0 baud rate divisors.
+//
+// Checks the IBRD, FBRD and HSE settings that UARTTxSetBaud() programs, as
+// worked out by UARTTxDivisor(), against the values from the TM4C123 data
+// sheet formula (BRD = clock / (16 or 8 * baud), FBRD = round(frac * 64)),
+// and the rates that cannot be made. The exit status is non-zero if any
+// check fails.
+//
+// Build and run on the host:
+//
+//   cc -std=gnu99 -I.. -o uart_baud_test uart_baud_test.c ../uart_baud.c
+//   ./uart_baud_test
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "check.h"
+#include "uart_tx.h"
+
+//*****************************************************************************
+//
+// The expected settings. The 16 MHz rows are the PIOSC that uartstdio
+// starts on; 50 MHz is the system clock main.c sets; 80 MHz is the fastest
+// BSP clock.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Clock;
+    uint32_t ui32Baud;
+    uint32_t ui32IBRD;
+    uint32_t ui32FBRD;
+    bool bHSE;
+    uint32_t ui32Actual;
+}
+tBaudCase;
+
+static const tBaudCase g_psBaudCases[] =
+{
+    { 50000000,    9600, 325, 33, false,    9600 },
+    { 50000000,  115200,  27,  8, false,  115207 },
+    { 50000000,  921600,   3, 25, false,  921659 },
+    { 50000000, 1500000,   2,  5, false, 1503759 },
+    { 50000000, 4000000,   1, 36, true,  4000000 },
+    { 16000000,  115200,   8, 44, false,  115108 },
+    { 16000000, 1500000,   1, 21, true,  1505882 },
+    { 80000000,  921600,   5, 27, false,  922190 },
+    { 80000000, 1500000,   3, 21, false, 1502347 },
+};
+
+#define NUM_BAUD_CASES             (sizeof(g_psBaudCases) /                 \
+                                    sizeof(g_psBaudCases[0]))
+
+int
+main(void)
+{
+    const tBaudCase *psCase;
+    uint32_t ui32Divisor, ui32Actual, i;
+    bool bHSE, bRight;
+
+    for(i = 0; i < NUM_BAUD_CASES; i++)
+    {
+        psCase = &g_psBaudCases[i];
+        ui32Actual = UARTTxDivisor(psCase->ui32Clock, psCase->ui32Baud,
+                                   &ui32Divisor, &bHSE);
+        bRight = ((ui32Actual == psCase->ui32Actual) &&
+                  ((ui32Divisor >> 6) == psCase->ui32IBRD) &&
+                  ((ui32Divisor & 63) == psCase->ui32FBRD) &&
+                  (bHSE == psCase->bHSE));
+        CHECK(bRight, "divisors from the data sheet formula");
+        if(!bRight)
+        {
+            printf("  %u baud at %u Hz: IBRD %u FBRD %u HSE %d, %u baud\n",
+                   psCase->ui32Baud, psCase->ui32Clock, ui32Divisor >> 6,
+                   ui32Divisor & 63, bHSE, ui32Actual);
+        }
+    }
+
+    //
+    // Out of reach: zero, faster than the clock over 8, and slower than the
+    // 16-bit IBRD allows.
+    //
+    CHECK((UARTTxDivisor(50000000, 0, &ui32Divisor, &bHSE) == 0) &&
+          (UARTTxDivisor(50000000, 7000000, &ui32Divisor, &bHSE) == 0) &&
+          (UARTTxDivisor(80000000, 50, &ui32Divisor, &bHSE) == 0),
+          "rates out of reach");
+
+    return(CHECK_SUMMARY());
+}
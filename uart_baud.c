@@ -0,0 +1,40 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "uart_tx.h"
+
+//*****************************************************************************
+//
+// Works out the divisor for ui32Baud from a ui32Clock UART clock. The
+// divisor is in 1/64ths, as IBRD:FBRD take it. High-speed mode, which
+// samples each bit 8 times instead of 16, is used only when the rate is
+// out of reach otherwise. Returns the achieved baud rate, or 0 if the rate
+// cannot be made.
+//
+// This is kept out of uart_tx.c so that the host test in tools/ can build
+// it; it must not depend on anything target specific.
+//
+//*****************************************************************************
+uint32_t
+UARTTxDivisor(uint32_t ui32Clock, uint32_t ui32Baud, uint32_t *pui32Divisor,
+              bool *pbHSE)
+{
+    uint32_t ui32Samples;
+
+    if(ui32Baud == 0)
+    {
+        return(0);
+    }
+    *pbHSE = (ui32Baud * 16) > ui32Clock;
+    ui32Samples = *pbHSE ? 8 : 16;
+
+    //
+    // Clock * 64 / (samples * baud), rounded to nearest.
+    //
+    *pui32Divisor = (((ui32Clock * (128 / ui32Samples)) / ui32Baud) + 1) / 2;
+    if((*pui32Divisor < 64) || (*pui32Divisor > ((65535 << 6) | 63)))
+    {
+        return(0);
+    }
+    return(((ui32Clock * (64 / ui32Samples)) + (*pui32Divisor / 2)) /
+           *pui32Divisor);
+}
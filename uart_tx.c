@@ -0,0 +1,407 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_uart.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+#include "utils/ustdlib.h"
+#include "priorities.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "uart_tx.h"
+
+//*****************************************************************************
+//
+// The transmit ring. The head is only moved by writers, inside a critical
+// section; the tail only by the UART0 interrupt, which the critical section
+// also masks. Both indices run freely and are wrapped on access.
+//
+//*****************************************************************************
+static char g_pcUARTTxBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint32_t g_ui32UARTTxHead;
+static volatile uint32_t g_ui32UARTTxTail;
+
+//*****************************************************************************
+//
+// Bytes dropped because the ring was full.
+//
+//*****************************************************************************
+static volatile uint32_t g_ui32UARTTxDropped;
+
+//*****************************************************************************
+//
+// The baud rate UART0 actually runs at, as set by UARTTxSetBaud(); 0 while
+// uartstdio's own setting is in force.
+//
+//*****************************************************************************
+static uint32_t g_ui32UARTTxBaud;
+
+//*****************************************************************************
+//
+// The receive ring. The head is only moved by the UART0 interrupt, the tail
+// only by UARTRxGet(), so neither side needs a critical section. Bytes that
+// arrive while the ring is full are dropped and counted.
+//
+//*****************************************************************************
+static char g_pcUARTRxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint32_t g_ui32UARTRxHead;
+static volatile uint32_t g_ui32UARTRxTail;
+static volatile uint32_t g_ui32UARTRxDropped;
+
+//
+// Called from the interrupt when a line ends; 0 while receive is off.
+//
+static void (*g_pfnUARTRxLine)(void);
+
+//*****************************************************************************
+//
+// Moves bytes from the ring into the TX FIFO until one runs out. Called with
+// the UART0 interrupt masked or from the interrupt itself.
+//
+//*****************************************************************************
+static void
+UARTTxPrime(void)
+{
+    while((g_ui32UARTTxTail != g_ui32UARTTxHead) &&
+          ROM_UARTSpaceAvail(UART0_BASE))
+    {
+        ROM_UARTCharPutNonBlocking(UART0_BASE,
+            g_pcUARTTxBuffer[g_ui32UARTTxTail & (UART_TX_BUFFER_SIZE - 1)]);
+        g_ui32UARTTxTail++;
+    }
+}
+
+//*****************************************************************************
+//
+// Switches UART0 to interrupt-driven transmission.
+//
+//*****************************************************************************
+void
+UARTTxInit(void)
+{
+    g_ui32UARTTxHead = 0;
+    g_ui32UARTTxTail = 0;
+    g_ui32UARTTxDropped = 0;
+
+    //
+    // Interrupt when the TX FIFO drains to 2/8 full, which leaves plenty of
+    // time to refill it before the line goes idle.
+    //
+    ROM_UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX2_8, UART_FIFO_RX4_8);
+    ROM_UARTIntEnable(UART0_BASE, UART_INT_TX);
+    ROM_IntPrioritySet(INT_UART0, PRIORITY_UART_INT << 5);
+    ROM_IntEnable(INT_UART0);
+}
+
+//*****************************************************************************
+//
+// Queues ui32Len bytes for transmission and returns how many were queued.
+// Whatever does not fit is dropped and counted. Never blocks. If bText is
+// set, newlines are sent as CR/LF, like UARTprintf() does.
+//
+//*****************************************************************************
+static uint32_t
+UARTTxQueue(const char *pcBuf, uint32_t ui32Len, bool bText)
+{
+    uint32_t ui32Count, ui32Head;
+
+    taskENTER_CRITICAL();
+
+    ui32Head = g_ui32UARTTxHead;
+    for(ui32Count = 0; ui32Count < ui32Len; ui32Count++)
+    {
+        if(bText && (pcBuf[ui32Count] == '\n'))
+        {
+            if((ui32Head - g_ui32UARTTxTail) > (UART_TX_BUFFER_SIZE - 2))
+            {
+                break;
+            }
+            g_pcUARTTxBuffer[ui32Head++ & (UART_TX_BUFFER_SIZE - 1)] = '\r';
+        }
+        else if((ui32Head - g_ui32UARTTxTail) == UART_TX_BUFFER_SIZE)
+        {
+            break;
+        }
+        g_pcUARTTxBuffer[ui32Head++ & (UART_TX_BUFFER_SIZE - 1)] =
+            pcBuf[ui32Count];
+    }
+    g_ui32UARTTxHead = ui32Head;
+    g_ui32UARTTxDropped += ui32Len - ui32Count;
+
+    //
+    // The TX interrupt only fires when the FIFO drains past its level, so
+    // an idle transmitter has to be started here.
+    //
+    UARTTxPrime();
+
+    taskEXIT_CRITICAL();
+
+    return(ui32Count);
+}
+
+//*****************************************************************************
+//
+// Queues text, sending newlines as CR/LF. Returns the number of bytes
+// queued; the rest are dropped.
+//
+//*****************************************************************************
+uint32_t
+UARTTxWrite(const char *pcBuf, uint32_t ui32Len)
+{
+    return(UARTTxQueue(pcBuf, ui32Len, true));
+}
+
+//*****************************************************************************
+//
+// Queues binary data unchanged. Returns the number of bytes queued; the
+// rest are dropped.
+//
+//*****************************************************************************
+uint32_t
+UARTTxWriteBinary(const uint8_t *pui8Buf, uint32_t ui32Len)
+{
+    return(UARTTxQueue((const char *)pui8Buf, ui32Len, false));
+}
+
+//*****************************************************************************
+//
+// A non-blocking UARTprintf(). Formats into a line buffer on the caller's
+// stack, then queues it with UARTTxWrite(). Returns the number of bytes
+// queued.
+//
+//*****************************************************************************
+uint32_t
+UARTTxPrintf(const char *pcString, ...)
+{
+    char pcLine[UART_TX_LINE_SIZE];
+    va_list vaArgP;
+    int iLen;
+
+    va_start(vaArgP, pcString);
+    iLen = uvsnprintf(pcLine, sizeof(pcLine), pcString, vaArgP);
+    va_end(vaArgP);
+
+    //
+    // uvsnprintf() returns the length the output would have had.
+    //
+    if(iLen >= (int)sizeof(pcLine))
+    {
+        taskENTER_CRITICAL();
+        g_ui32UARTTxDropped += iLen - (sizeof(pcLine) - 1);
+        taskEXIT_CRITICAL();
+        iLen = sizeof(pcLine) - 1;
+    }
+    return(UARTTxWrite(pcLine, iLen));
+}
+
+//*****************************************************************************
+//
+// Returns the number of bytes dropped since UARTTxInit().
+//
+//*****************************************************************************
+uint32_t
+UARTTxDropped(void)
+{
+    return(g_ui32UARTTxDropped);
+}
+
+//*****************************************************************************
+//
+// Returns the number of bytes UARTTxWrite() can queue right now.
+//
+//*****************************************************************************
+uint32_t
+UARTTxSpace(void)
+{
+    return(UART_TX_BUFFER_SIZE - (g_ui32UARTTxHead - g_ui32UARTTxTail));
+}
+
+//*****************************************************************************
+//
+// Returns true while queued output has still to leave the UART.
+//
+//*****************************************************************************
+bool
+UARTTxBusy(void)
+{
+    return((g_ui32UARTTxTail != g_ui32UARTTxHead) ||
+           ROM_UARTBusy(UART0_BASE));
+}
+
+//*****************************************************************************
+//
+// Clocks UART0 from the system clock and sets it to ui32Baud, 8-N-1.
+// Waits for everything already queued to go out first. Returns false, and
+// leaves the UART alone, if the rate is more than 2% off what the system
+// clock can make. The divisor is only right for the current system clock,
+// so call it again if that changes.
+//
+//*****************************************************************************
+bool
+UARTTxSetBaud(uint32_t ui32Baud)
+{
+    uint32_t ui32Clock, ui32Divisor, ui32Actual, ui32Error;
+    bool bHSE;
+
+    ui32Clock = ROM_SysCtlClockGet();
+    ui32Actual = UARTTxDivisor(ui32Clock, ui32Baud, &ui32Divisor, &bHSE);
+    ui32Error = (ui32Actual > ui32Baud) ? (ui32Actual - ui32Baud) :
+                                          (ui32Baud - ui32Actual);
+    if((ui32Actual == 0) || (ui32Error > (ui32Baud / 50)))
+    {
+        return(false);
+    }
+
+    //
+    // Drain the ring. Prime it here too, since the UART interrupt is still
+    // masked if the scheduler has not started.
+    //
+    while(g_ui32UARTTxTail != g_ui32UARTTxHead)
+    {
+        taskENTER_CRITICAL();
+        UARTTxPrime();
+        taskEXIT_CRITICAL();
+    }
+
+    //
+    // UARTDisable() waits for the last character to leave the shifter. The
+    // divisors take effect on the following LCRH write.
+    //
+    ROM_UARTDisable(UART0_BASE);
+    UARTClockSourceSet(UART0_BASE, UART_CLOCK_SYSTEM);
+    if(bHSE)
+    {
+        HWREG(UART0_BASE + UART_O_CTL) |= UART_CTL_HSE;
+    }
+    else
+    {
+        HWREG(UART0_BASE + UART_O_CTL) &= ~UART_CTL_HSE;
+    }
+    HWREG(UART0_BASE + UART_O_IBRD) = ui32Divisor >> 6;
+    HWREG(UART0_BASE + UART_O_FBRD) = ui32Divisor & 63;
+    HWREG(UART0_BASE + UART_O_LCRH) = UART_LCRH_WLEN_8;
+    ROM_UARTEnable(UART0_BASE);
+
+    g_ui32UARTTxBaud = ui32Actual;
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Returns the baud rate set by UARTTxSetBaud(), or 0 if it has not been
+// called.
+//
+//*****************************************************************************
+uint32_t
+UARTTxBaud(void)
+{
+    return(g_ui32UARTTxBaud);
+}
+
+//*****************************************************************************
+//
+// Turns on interrupt-driven receive. pfnLine is called from the UART0
+// interrupt whenever a carriage return or line feed arrives, or the ring
+// overflows, so it must only use FromISR kernel calls. The bytes themselves
+// are then fetched with UARTRxGet().
+//
+//*****************************************************************************
+void
+UARTRxInit(void (*pfnLine)(void))
+{
+    g_ui32UARTRxHead = 0;
+    g_ui32UARTRxTail = 0;
+    g_ui32UARTRxDropped = 0;
+    g_pfnUARTRxLine = pfnLine;
+
+    //
+    // The receive timeout interrupt picks up bytes left below the FIFO
+    // level, as typed characters usually are.
+    //
+    ROM_UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+}
+
+//*****************************************************************************
+//
+// Takes the oldest received byte. Returns false if there is none.
+//
+//*****************************************************************************
+bool
+UARTRxGet(char *pcChar)
+{
+    if(g_ui32UARTRxTail == g_ui32UARTRxHead)
+    {
+        return(false);
+    }
+    *pcChar = g_pcUARTRxBuffer[g_ui32UARTRxTail & (UART_RX_BUFFER_SIZE - 1)];
+    g_ui32UARTRxTail++;
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Returns the number of received bytes dropped since UARTRxInit().
+//
+//*****************************************************************************
+uint32_t
+UARTRxDropped(void)
+{
+    return(g_ui32UARTRxDropped);
+}
+
+//*****************************************************************************
+//
+// Returns true once UARTRxInit() has turned receive on.
+//
+//*****************************************************************************
+bool
+UARTRxEnabled(void)
+{
+    return(g_pfnUARTRxLine != 0);
+}
+
+//*****************************************************************************
+//
+// UART0 interrupt handler. Empties the RX FIFO into the receive ring and
+// refills the TX FIFO from the transmit ring.
+//
+//*****************************************************************************
+void
+UARTIntHandler(void)
+{
+    bool bLine = false;
+    char cChar;
+
+    ROM_UARTIntClear(UART0_BASE, ROM_UARTIntStatus(UART0_BASE, true));
+
+    while(ROM_UARTCharsAvail(UART0_BASE))
+    {
+        cChar = ROM_UARTCharGetNonBlocking(UART0_BASE);
+        if((g_ui32UARTRxHead - g_ui32UARTRxTail) == UART_RX_BUFFER_SIZE)
+        {
+            g_ui32UARTRxDropped++;
+            bLine = true;
+        }
+        else
+        {
+            g_pcUARTRxBuffer[g_ui32UARTRxHead & (UART_RX_BUFFER_SIZE - 1)] =
+                cChar;
+            g_ui32UARTRxHead++;
+            if((cChar == '\r') || (cChar == '\n'))
+            {
+                bLine = true;
+            }
+        }
+    }
+    if(bLine && (g_pfnUARTRxLine != 0))
+    {
+        g_pfnUARTRxLine();
+    }
+
+    UARTTxPrime();
+}
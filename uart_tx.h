@@ -0,0 +1,44 @@
+#ifndef __UART_TX_H__
+#define __UART_TX_H__
+
+//*****************************************************************************
+//
+// Buffered, interrupt-driven transmit path for UART0. Output is copied into
+// a ring buffer that the UART0 interrupt drains into the TX FIFO, so callers
+// never wait for the line. If the ring is full the rest of the output is
+// dropped and counted rather than stalling the caller.
+//
+// The same interrupt collects received bytes into a smaller ring, and tells
+// the owner of the receive side each time a line ends.
+//
+//*****************************************************************************
+
+// Size of the transmit ring, in bytes; must be a power of two.
+#define UART_TX_BUFFER_SIZE        256
+
+// Longest line UARTTxPrintf() formats; longer output is truncated.
+#define UART_TX_LINE_SIZE          80
+
+// Size of the receive ring, in bytes; must be a power of two.
+#define UART_RX_BUFFER_SIZE        64
+
+// Prototypes for the buffered transmit path. UARTTxInit() must be called
+// after UARTStdioConfig(0, ...).
+extern void UARTTxInit(void);
+extern uint32_t UARTTxWrite(const char *pcBuf, uint32_t ui32Len);
+extern uint32_t UARTTxWriteBinary(const uint8_t *pui8Buf, uint32_t ui32Len);
+extern uint32_t UARTTxPrintf(const char *pcString, ...);
+extern uint32_t UARTTxDropped(void);
+extern uint32_t UARTTxSpace(void);
+extern bool UARTTxBusy(void);
+extern uint32_t UARTTxDivisor(uint32_t ui32Clock, uint32_t ui32Baud,
+                              uint32_t *pui32Divisor, bool *pbHSE);
+extern bool UARTTxSetBaud(uint32_t ui32Baud);
+extern uint32_t UARTTxBaud(void);
+extern void UARTRxInit(void (*pfnLine)(void));
+extern bool UARTRxGet(char *pcChar);
+extern uint32_t UARTRxDropped(void);
+extern bool UARTRxEnabled(void);
+extern void UARTIntHandler(void);
+
+#endif // __UART_TX_H__